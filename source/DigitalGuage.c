@@ -15,10 +15,12 @@
 #include "MKL25Z4.h"
 #include "fsl_debug_console.h"
 #include "statemachine.h"
+#include "mem.h"
 
 
 int main(void)
 {
+	mem_paint_stack();						/*First, so the whole run is covered by the high-water mark*/
 
   	/* Init board hardware. */
 	BOARD_InitBootPins();
@@ -13,6 +13,13 @@
 
 #include <LEDs.h>
 #include <MKL25Z4.h>
+#include "profiler.h"
+#include "latency.h"
+#include "deferred.h"
+#include "boottime.h"
+#include "sysclock.h"
+#include "critical.h"
+#include "irqstat.h"
 
 #define RED_LED_PIN (18)								/*Macro for port B 18th pin to access it as red led*/
 #define RED_LED_PIN_CTRL_REG PORTB->PCR[RED_LED_PIN]/*Program control Register macro for port B 18th pin*/
@@ -28,12 +35,30 @@
 #define CHANNEL_0 	(0)
 
 #define CONTINUE_OPERATION (3)
+#define LED_IRQ_PRIORITY (2)	/*Above the PendSV bottom halves, the fade steps are posted there*/
+#define NUM_COLOURS (3)
+#define RED_INDEX (0)
+#define GREEN_INDEX (1)
+#define BLUE_INDEX (2)
+#define TPM_MAX_PRESCALE (7)		/*Largest TPM_SC_PS, divides by 128*/
+#define TPM_MAX_COUNTS (65536)
+#define FRACTION_BITS (16)			/*Fade state is the 0-255 color value in 8.16 fixed point*/
+
+static volatile uint32_t fade_current[NUM_COLOURS];	/*Color currently shown, 8.16 fixed point*/
+static volatile int32_t fade_step[NUM_COLOURS];		/*Added every PWM period*/
+static volatile uint32_t fade_target[NUM_COLOURS];
+static volatile uint32_t fade_periods_left = 0;
+static volatile bool fade_step_queued = false;		/*Set while the bottom half is queued*/
+static volatile bool fade_first_step = false;		/*Set until a posted fade first writes the compare values*/
+static bool leds_ready = false;						/*Set once the PWM of the three LEDs is initialized*/
+
 /*
  * @brief: Initializes the Timer PWM module 0 channel 1 connected to blue led (Port D 1)
- * @param: Loading the MOD value with 48000 for 500 Hz PWM frequency
+ * @param1: period counts per PWM period, loaded to MOD as period-1
+ * @param2: prescale TPM clock prescaler as a power of 2
  * @return:void
  */
-void Init_Blue_LED_PWM(uint16_t period)
+void Init_Blue_LED_PWM(uint16_t period, uint8_t prescale)
 {
 	/*Initialization of clock for port D and configuration of port D 1st pin for TPM*/
 
@@ -47,10 +72,9 @@ void Init_Blue_LED_PWM(uint16_t period)
 	/*Configuring the TPM0 module with channel 1 */
 	SIM->SCGC6 |= SIM_SCGC6_TPM0_MASK;/*Setting the clock controlled by the System Integration Module
 	 	 	 	 	 	 	 	 	 	 for TPM module*/
-	SIM->SOPT2 |= (SIM_SOPT2_TPMSRC(1) | SIM_SOPT2_PLLFLLSEL_MASK); /*Setting the clock source for
-																	TPM as 48 MHz*/
-	TPM0->MOD = period-1; /*Loading the MOD value with 47999 for 500 Hz PWM frequency*/
-	TPM0->SC =  TPM_SC_PS(1);/*Configuring TPM as UP counter with a prescaler of 2*/
+	SIM->SOPT2 |= SIM_SOPT2_TPMSRC(1);	/*Clocking the TPM from the PLL/FLL peripheral clock of the clock profile*/
+	TPM0->MOD = period-1;	/*Loading the MOD value for PWM_FREQUENCY_HZ*/
+	TPM0->SC =  TPM_SC_PS(prescale);/*Configuring TPM as UP counter with a prescaler of 2^prescale*/
 	TPM0->CONF |= TPM_CONF_DBGMODE(CONTINUE_OPERATION);/*Continuing operation in debug mode*/
 	TPM0->CONTROLS[CHANNEL_1].CnSC = TPM_CnSC_MSB_MASK | TPM_CnSC_ELSA_MASK; /*Setting channel 1 of TPM0
 																			to edge-aligned low-true PWM*/
@@ -61,11 +85,12 @@ void Init_Blue_LED_PWM(uint16_t period)
 
 /*
  * @brief: Initializes the Timer PWM module 2 channel 0 connected to red led (Port B 18)
- * @param: Loading the MOD value with 48000 for 500 Hz PWM frequency
+ * @param1: period counts per PWM period, loaded to MOD as period-1
+ * @param2: prescale TPM clock prescaler as a power of 2
  * @return:void
  */
 
-void Init_Red_LED_PWM(uint16_t period)
+void Init_Red_LED_PWM(uint16_t period, uint8_t prescale)
 {
 	/*Initialization of clock for port B and configuration of port B 18th pin for TPM*/
 
@@ -79,23 +104,27 @@ void Init_Red_LED_PWM(uint16_t period)
 	/*Configuring the TPM2 module with channel 0 */
 	SIM->SCGC6 |= SIM_SCGC6_TPM2_MASK; /*Setting the clock controlled by the System Integration Module
 	 	 	 	 	 	 	 	 	 	 for TPM module*/
-	SIM->SOPT2 |= (SIM_SOPT2_TPMSRC(1) | SIM_SOPT2_PLLFLLSEL_MASK);/*Setting the clock source
-	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 for TPM as 48 MHz*/
-	TPM2->MOD = period-1;/*Loading the MOD value with 47999 for 500 Hz PWM frequency*/
-	TPM2->SC =  TPM_SC_PS(1);/*Configuring TPM as UP counter with a prescaler of 2*/
+	SIM->SOPT2 |= SIM_SOPT2_TPMSRC(1);	/*Clocking the TPM from the PLL/FLL peripheral clock of the clock profile*/
+	TPM2->MOD = period-1;	/*Loading the MOD value for PWM_FREQUENCY_HZ*/
+	TPM2->SC =  TPM_SC_PS(prescale);/*Configuring TPM as UP counter with a prescaler of 2^prescale*/
 	TPM2->CONF |= TPM_CONF_DBGMODE(CONTINUE_OPERATION);/*Continuing operation in debug mode*/
 	TPM2->CONTROLS[CHANNEL_0].CnSC = TPM_CnSC_MSB_MASK | TPM_CnSC_ELSA_MASK; /*Setting channel 0 of TPM2
 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 to edge-aligned low-true PWM*/
 	TPM2->CONTROLS[CHANNEL_0].CnV = 0;/* Initializing the duty cycle with value 0*/
 	TPM2->SC |= TPM_SC_CMOD(1);/*Enabling the TPM module*/
+	NVIC_SetPriority(TPM2_IRQn, LED_IRQ_PRIORITY);/*Overflow interrupt drives the color fades,
+	 	 	 	 	 	 	 	 	 	 	 	 only enabled in TPM2 while a fade runs*/
+	NVIC_ClearPendingIRQ(TPM2_IRQn);
+	NVIC_EnableIRQ(TPM2_IRQn);
 }
 
 /*
  * @brief: Initializes the Timer PWM module 2 channel 1 connected to green led (Port B 19)
- * @param: Loading the MOD value with 48000 for 500 Hz PWM frequency
+ * @param1: period counts per PWM period, loaded to MOD as period-1
+ * @param2: prescale TPM clock prescaler as a power of 2
  * @return:void
  */
-void Init_Green_LED_PWM(uint16_t period)
+void Init_Green_LED_PWM(uint16_t period, uint8_t prescale)
 {
 	/*Configuration of port B 19th pin for TPM*/
 	GREEN_LED_PIN_CTRL_REG &= ~PORT_PCR_MUX_MASK; /*Masking PortB 18 Pin Control Register with 0x700
@@ -106,10 +135,9 @@ void Init_Green_LED_PWM(uint16_t period)
 	/*Configuring the TPM2 module with channel 1 */
 	SIM->SCGC6 |= SIM_SCGC6_TPM2_MASK;/*Setting the clock controlled by the System Integration Module
 	 	 	 	 	 	 	 	 	 	 for TPM module*/
-	SIM->SOPT2 |= (SIM_SOPT2_TPMSRC(1) | SIM_SOPT2_PLLFLLSEL_MASK);/*Setting the clock source
-	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 for TPM as 48 MHz*/
-	TPM2->MOD = period-1;/*Loading the MOD value with 47999 for 500 Hz PWM frequency*/
-	TPM2->SC =  TPM_SC_PS(1);/*Configuring TPM as UP counter with a prescaler of 2*/
+	SIM->SOPT2 |= SIM_SOPT2_TPMSRC(1);	/*Clocking the TPM from the PLL/FLL peripheral clock of the clock profile*/
+	TPM2->MOD = period-1;	/*Loading the MOD value for PWM_FREQUENCY_HZ*/
+	TPM2->SC =  TPM_SC_PS(prescale);/*Configuring TPM as UP counter with a prescaler of 2^prescale*/
 	TPM2->CONF |= TPM_CONF_DBGMODE(CONTINUE_OPERATION);/*Continuing operation in debug mode*/
 	TPM2->CONTROLS[CHANNEL_1].CnSC = TPM_CnSC_MSB_MASK | TPM_CnSC_ELSA_MASK;/*Setting channel 0 of TPM2
 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 	 to edge-aligned low-true PWM*/
@@ -132,8 +160,160 @@ void Init_Green_LED_PWM(uint16_t period)
 void update_led_colour(uint16_t redValue1,uint16_t greenValue1,uint16_t blueValue1)
 {
 	/*Setting the duty cycle for Red, Green, Blue each ranging from 0-255 */
+	PROF_BEGIN(PROF_UPDATE_LED);
+	led_fade_to(redValue1, greenValue1, blueValue1, 0);
+   	PROF_END(PROF_UPDATE_LED);
+}
+
+/*
+ * @brief: Loads the TPM compare values from the fade state
+ * @return:void
+ */
+static void write_fade_colour(void)
+{
+   	TPM2->CONTROLS[CHANNEL_0].CnV = (fade_current[RED_INDEX] >> FRACTION_BITS) << 0x08;
+   	TPM2->CONTROLS[CHANNEL_1].CnV = (fade_current[GREEN_INDEX] >> FRACTION_BITS) << 0x08;
+   	TPM0->CONTROLS[CHANNEL_1].CnV = (fade_current[BLUE_INDEX] >> FRACTION_BITS) << 0x08;
+}
+
+/*
+ * @brief: Initializes the PWM of the three LEDs, does nothing if already initialized
+ * @return:void
+ */
+void leds_start(void)
+{
+	if (leds_ready)
+	{
+		return;
+	}
+	leds_ready = true;
+	uint64_t start = timebase_cycles64();
+
+	/*Smallest prescaler which fits one PWM period of the profile clock in the 16 bit counter*/
+	uint32_t counts = sysclock_profile()->peripheral_hz / PWM_FREQUENCY_HZ;
+	uint8_t prescale = 0;
+	while ((counts > TPM_MAX_COUNTS) && (prescale < TPM_MAX_PRESCALE))
+	{
+		counts >>= 1;
+		prescale++;
+	}
+	uint16_t period = (uint16_t)(counts > TPM_MAX_COUNTS ? TPM_MAX_COUNTS : counts);
 
-   	TPM2->CONTROLS[0].CnV = redValue1 << 0x08;
-   	TPM2->CONTROLS[1].CnV = greenValue1 << 0x08;
-   	TPM0->CONTROLS[1].CnV = blueValue1 << 0x08;
+	Init_Red_LED_PWM(period, prescale);				/*Initializes the Timer PWM module 2 channel 0 connected to red led (Port B 18)*/
+	Init_Green_LED_PWM(period, prescale);			/* Initializes the Timer PWM module 2 channel 1 connected to green led (Port B 19)*/
+	Init_Blue_LED_PWM(period, prescale);			/* Initializes the Timer PWM module 0 channel 1 connected to blue led (Port D 1)*/
+	boottime_record("LED PWM", start);
+}
+
+/*
+ * @brief: Fades the on-board Red, Blue, Green colors to a target color
+ *
+ * @param1: Red target ranging from 0-255
+ * @param2: Green target ranging from 0-255
+ * @param3: Blue target ranging from 0-255
+ * @param4: transition_ms duration of the fade, 0 to change color immediately
+ * @return:void
+ */
+void led_fade_to(uint8_t redValue, uint8_t greenValue, uint8_t blueValue, uint32_t transition_ms)
+{
+	uint32_t periods = (transition_ms * PWM_FREQUENCY_HZ) / 1000;	/*Number of PWM periods in the fade*/
+	uint32_t target[NUM_COLOURS] = {(uint32_t)redValue << FRACTION_BITS, (uint32_t)greenValue << FRACTION_BITS,
+									(uint32_t)blueValue << FRACTION_BITS};
+
+	leds_start();							/*Initialized on first use*/
+	crit_state_t masking_state = crit_enter(CRIT_LED_FADE);	/*The fade bottom half must not see half a target*/
+	for (int colour = 0; colour < NUM_COLOURS; colour++)
+	{
+		fade_target[colour] = target[colour];
+		if (periods == 0)
+		{
+			fade_current[colour] = target[colour];
+			fade_step[colour] = 0;
+		}
+		else
+		{
+			fade_step[colour] = ((int32_t)target[colour] - (int32_t)fade_current[colour]) / (int32_t)periods;
+		}
+	}
+	fade_periods_left = periods;
+	fade_first_step = (periods != 0);
+	if (periods == 0)
+	{
+		TPM2->SC &= ~TPM_SC_TOIE_MASK;
+		write_fade_colour();
+	}
+	else
+	{
+		TPM2->SC |= TPM_SC_TOF_MASK | TPM_SC_TOIE_MASK;	/*Drop a stale overflow, first step on the next one*/
+	}
+	crit_exit(CRIT_LED_FADE, masking_state);
+	if (periods == 0)
+	{
+		LAT_STAMP(LAT_CNV_WRITTEN);
+	}
+}
+
+/*
+ * @brief: Bottom half of the TPM2 overflow, advances a running fade by one PWM period
+ *
+ * The compare values written here are latched by the TPMs at the end of the current
+ * period, so the duty cycle never changes in the middle of a period
+ *
+ * @param: arg unused
+ * @return:void
+ */
+static void fade_bottom_half(void *arg)
+{
+	fade_step_queued = false;
+	if (fade_periods_left == 0)
+	{
+		return;
+	}
+	fade_periods_left--;
+	for (int colour = 0; colour < NUM_COLOURS; colour++)
+	{
+		if (fade_periods_left == 0)
+		{
+			fade_current[colour] = fade_target[colour];	/*Land exactly on the target despite rounding*/
+		}
+		else
+		{
+			fade_current[colour] += fade_step[colour];
+		}
+	}
+	write_fade_colour();
+	if (fade_first_step)
+	{
+		fade_first_step = false;
+		LAT_STAMP(LAT_CNV_WRITTEN);				/*The tilt first shows on the LEDs from here*/
+	}
+	if (fade_periods_left == 0)
+	{
+		TPM2->SC &= ~TPM_SC_TOIE_MASK;
+	}
+}
+
+/*
+ * @brief: TPM2 overflow interrupt, top half of the fade engine
+ *
+ * Only clears the flag and defers the interpolation to the bottom half. An overflow
+ * while the previous step is still queued is dropped, the fade then ends one period
+ * later
+ *
+ * @return:void
+ */
+void TPM2_IRQHandler(void)
+{
+	IRQ_STAT_ENTER(IRQ_LATENCY_TPM(TPM2));		/*Before clearing the flag, the counter restarted at the overflow*/
+	TPM2->SC |= TPM_SC_TOF_MASK;				/*Writing 1 clears the overflow flag*/
+	if (fade_periods_left == 0)
+	{
+		TPM2->SC &= ~TPM_SC_TOIE_MASK;
+	}
+	else if (!fade_step_queued)
+	{
+		fade_step_queued = true;
+		deferred_post(fade_bottom_half, NULL);
+	}
+	IRQ_STAT_EXIT(IRQ_STAT_TPM2);
 }
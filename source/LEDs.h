@@ -16,28 +16,31 @@
 
 #include "MKL25Z4.h"
 
-#define PWM_PERIOD (48000) /*To load MOD value with 48000 for 500 Hz PWM frequency*/
+#define PWM_FREQUENCY_HZ (500)	/*MOD and prescaler are derived from the clock profile*/
 
 /*
  * @brief: Initializes the Timer PWM module 0 channel 1 connected to blue led (Port D 1)
- * @param: Loading the MOD value with 48000 for 500 Hz PWM frequency
+ * @param1: period counts per PWM period, loaded to MOD as period-1
+ * @param2: prescale TPM clock prescaler as a power of 2
  * @return:void
  */
-void Init_Blue_LED_PWM(uint16_t period);
+void Init_Blue_LED_PWM(uint16_t period, uint8_t prescale);
 
 /*
  * @brief: Initializes the Timer PWM module 2 channel 0 connected to red led (Port B 18)
- * @param: Loading the MOD value with 48000 for 500 Hz PWM frequency
+ * @param1: period counts per PWM period, loaded to MOD as period-1
+ * @param2: prescale TPM clock prescaler as a power of 2
  * @return:void
  */
-void Init_Red_LED_PWM(uint16_t period);
+void Init_Red_LED_PWM(uint16_t period, uint8_t prescale);
 
 /*
  * @brief: Initializes the Timer PWM module 2 channel 1 connected to green led (Port B 19)
- * @param: Loading the MOD value with 48000 for 500 Hz PWM frequency
+ * @param1: period counts per PWM period, loaded to MOD as period-1
+ * @param2: prescale TPM clock prescaler as a power of 2
  * @return:void
  */
-void Init_Green_LED_PWM(uint16_t period);
+void Init_Green_LED_PWM(uint16_t period, uint8_t prescale);
 
 
 /*
@@ -53,5 +56,29 @@ void Init_Green_LED_PWM(uint16_t period);
  */
 void update_led_colour(uint16_t redValue,uint16_t greenValue,uint16_t blueValue);
 
+/*
+ * @brief: Initializes the PWM of the three LEDs, does nothing if already initialized
+ *
+ * Called by the first color change, so the LEDs need no initialization at boot
+ *
+ * @return:void
+ */
+void leds_start(void);
+
+/*
+ * @brief: Fades the on-board Red, Blue, Green colors to a target color
+ *
+ * The color is interpolated in the TPM2 overflow interrupt, once per PWM period, so every
+ * compare value update is latched at a period boundary and the transition is glitch-free.
+ * A new target replaces the one in progress and starts from the color currently shown.
+ *
+ * @param1: Red target ranging from 0-255
+ * @param2: Green target ranging from 0-255
+ * @param3: Blue target ranging from 0-255
+ * @param4: transition_ms duration of the fade, 0 to change color immediately
+ * @return:void
+ */
+void led_fade_to(uint8_t redValue, uint8_t greenValue, uint8_t blueValue, uint32_t transition_ms);
+
 
 #endif /* TIMERS_H_ */
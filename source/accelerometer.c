@@ -14,9 +14,21 @@
 #include <math.h>
 #include "fsl_debug_console.h"
 #include "stdio.h"
+#include "profiler.h"
+#include "latency.h"
+#include "idle.h"
+#include "timer.h"
+#include "ramfunc.h"
+#include "boottime.h"
+#include "probe.h"
 
 int16_t acc_X=0, acc_Y=0, acc_Z=0;
 float roll=0.0, pitch=0.0;
+static bool mma_ready = false;				/*Set once the I2C bus and the accelerometer are initialized*/
+static mma_calibration_t calibration = {{0, 0, 0}, {MMA_GAIN_UNITY, MMA_GAIN_UNITY, MMA_GAIN_UNITY}, {0, 0, 0}, 0};
+
+static void mma_set_active(bool active);
+static void mma_write_offsets(void);
 
 /*
  * @brief Initializes the acclerometer
@@ -26,23 +38,43 @@ float roll=0.0, pitch=0.0;
 
 int init_mma()
 {
-	i2c_write_byte(MMA_ADDR, REG_CTRL1, 0x01);  /*set active mode, 14 bit samples and 800 Hz ODR*/
+	i2c_write_byte(MMA_ADDR, REG_CTRL1, CTRL1_ACTIVE);  /*set active mode, 14 bit samples and 800 Hz ODR*/
 	return 1;
 }
 
+/*
+ * @brief Initializes the I2C bus and the accelerometer, does nothing if already initialized
+ *
+ * @return void
+ */
+void mma_start(void)
+{
+	if (mma_ready)
+	{
+		return;
+	}
+	mma_ready = true;
+	uint64_t start = timebase_cycles64();
+	i2c_init();										/* Initialize i2c*/
+	init_mma();										/* Initialize the accelerometer*/
+	mma_write_offsets();
+	boottime_record("I2C and accelerometer", start);
+}
+
 
 /*
- * @brief Funciton to get the roll
+ * @brief Reads one frame of the three axes
  *
- * @return roll value
+ * @param xyz X, Y and Z acceleration in 14 bit counts
+ * @return void
  */
 
-int get_roll()
+RAMFUNC void mma_read_xyz(int16_t xyz[3])
 {
 	int i;
 	uint8_t data[6];
-	int16_t temp[3];
-	int roll=0;
+
+	mma_start();									/*Initialized on first use*/
 	i2c_start();
 	i2c_read_setup(MMA_ADDR , REG_XHI);
 
@@ -55,17 +87,344 @@ int get_roll()
 
 	for ( i=0; i<3; i++ )
 	{
-		temp[i] = (int16_t) ((data[2*i]<<8) | data[2*i+1]);
+		xyz[i] = ((int16_t) ((data[2*i]<<8) | data[2*i+1]))/4;	/*14 bits alignment*/
+	}
+}
+
+/*
+ * @brief Puts the accelerometer in standby or active mode at the default 800 Hz ODR
+ *
+ * The configuration registers can only be written in standby mode
+ *
+ * @param active true for active mode
+ * @return void
+ */
+static void mma_set_active(bool active)
+{
+	i2c_write_byte(MMA_ADDR, REG_CTRL1, active ? CTRL1_ACTIVE : 0x00);
+}
+
+/*
+ * @brief Waits for a new frame of all three axes
+ *
+ * @return true if a frame is ready, false on timeout
+ */
+static bool mma_wait_frame(void)
+{
+	ticktime start = timebase_ticks();
+	while ((i2c_read_byte(MMA_ADDR, REG_STATUS) & STATUS_ZYXDR) == 0)
+	{
+		if ((timebase_ticks() - start) > MMA_FRAME_TIMEOUT_MS)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+ * @brief Averages new frames after dropping the ones taken while the output settles
+ *
+ * @param average average of every axis
+ * @return true if every frame was read, false on timeout
+ */
+static bool mma_average_frames(int32_t average[3])
+{
+	int16_t xyz[3];
+	int32_t sum[3] = {0, 0, 0};
+
+	for (int frame = 0; frame < (MMA_SELF_TEST_SETTLE_FRAMES + MMA_SELF_TEST_FRAMES); frame++)
+	{
+		if (!mma_wait_frame())
+		{
+			return false;
+		}
+		mma_read_xyz(xyz);								/*Reading the frame clears the data ready flag*/
+		if (frame < MMA_SELF_TEST_SETTLE_FRAMES)
+		{
+			continue;
+		}
+		for (int axis = 0; axis < 3; axis++)
+		{
+			sum[axis] += xyz[axis];
+		}
+	}
+	for (int axis = 0; axis < 3; axis++)
+	{
+		average[axis] = sum[axis] / MMA_SELF_TEST_FRAMES;
+	}
+	return true;
+}
+
+/*
+ * @brief Electrical self-test of the accelerometer
+ *
+ * Checks WHO_AM_I, then averages frames with the self-test bit of CTRL_REG2 clear and
+ * set in 4g mode. The self-test force moves every axis by a fixed amount whatever the
+ * orientation of the board, the difference must be between half and twice the typical
+ * datasheet value. The 2g mode used for the roll is restored afterwards
+ *
+ * @param result WHO_AM_I value and the measured output change of every axis
+ * @return true if passed
+ */
+bool mma_self_test(mma_self_test_t *result)
+{
+	static const int16_t typical_delta[3] = {MMA_ST_DELTA_X, MMA_ST_DELTA_Y, MMA_ST_DELTA_Z};
+	int32_t off[3];
+	int32_t on[3];
+	bool read_ok;
+
+	result->passed = false;
+	mma_start();
+	result->who_am_i = i2c_read_byte(MMA_ADDR, REG_WHO_AM_I);
+	for (int axis = 0; axis < 3; axis++)
+	{
+		result->delta[axis] = 0;
+	}
+	if (result->who_am_i != MMA_WHO_AM_I_VALUE)
+	{
+		return false;
+	}
+
+	mma_set_active(false);
+	i2c_write_byte(MMA_ADDR, REG_XYZ_DATA_CFG, XYZ_DATA_CFG_FS_4G);
+	i2c_write_byte(MMA_ADDR, REG_CTRL2, 0x00);
+	mma_set_active(true);
+	read_ok = mma_average_frames(off);
+
+	mma_set_active(false);
+	i2c_write_byte(MMA_ADDR, REG_CTRL2, CTRL2_ST);
+	mma_set_active(true);
+	read_ok = read_ok && mma_average_frames(on);
+
+	mma_set_active(false);
+	i2c_write_byte(MMA_ADDR, REG_CTRL2, 0x00);
+	i2c_write_byte(MMA_ADDR, REG_XYZ_DATA_CFG, XYZ_DATA_CFG_FS_2G);
+	mma_set_active(true);
+
+	if (!read_ok)
+	{
+		return false;
 	}
+	result->passed = true;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		result->delta[axis] = on[axis] - off[axis];
+		if ((result->delta[axis] < (typical_delta[axis] / 2)) || (result->delta[axis] > (typical_delta[axis] * 2)))
+		{
+			result->passed = false;
+		}
+	}
+	return result->passed;
+}
+
+
+/*
+ * @brief Averages frames of the three axes after letting the output settle
+ *
+ * @param average average of every axis in 14 bit counts
+ * @return true if every frame was read, false on timeout
+ */
+bool mma_average(int32_t average[3])
+{
+	mma_start();
+	return mma_average_frames(average);
+}
+
+/*
+ * @brief Writes the hardware offsets to the OFF registers, in standby
+ *
+ * @return void
+ */
+static void mma_write_offsets(void)
+{
+	mma_set_active(false);
+	for (int axis = 0; axis < 3; axis++)
+	{
+		i2c_write_byte(MMA_ADDR, REG_OFF_X + axis, (uint8_t)calibration.hw_offset[axis]);
+	}
+	mma_set_active(true);
+}
+
+/*
+ * @brief Applies the offset and gain calibration to a frame, in integer math
+ *
+ * @param xyz X, Y and Z acceleration in 14 bit counts, corrected in place
+ * @return void
+ */
+void mma_correct(int16_t xyz[3])
+{
+	for (int axis = 0; axis < 3; axis++)
+	{
+		int32_t value = ((int32_t)xyz[axis] - calibration.offset[axis]) * calibration.gain[axis];
+		xyz[axis] = (int16_t)((value + (1 << (MMA_GAIN_SHIFT - 1))) >> MMA_GAIN_SHIFT);
+	}
+}
+
+/*
+ * @brief Sets the calibration used by mma_correct() and the OFF registers
+ *
+ * @param new_calibration calibration to use, NULL for none
+ * @return void
+ */
+void mma_set_calibration(const mma_calibration_t *new_calibration)
+{
+	static const mma_calibration_t none = {{0, 0, 0}, {MMA_GAIN_UNITY, MMA_GAIN_UNITY, MMA_GAIN_UNITY}, {0, 0, 0}, 0};
+
+	calibration = (new_calibration != NULL) ? *new_calibration : none;
+	if (mma_ready)									/*Otherwise written by mma_start()*/
+	{
+		mma_write_offsets();
+	}
+}
+
+/*
+ * @brief Returns the calibration in use
+ *
+ * @param current filled with the calibration
+ * @return void
+ */
+void mma_get_calibration(mma_calibration_t *current)
+{
+	*current = calibration;
+}
+
+/*
+ * @brief Solves the offset and gain of every axis from the board resting on its six faces
+ *
+ * @param1 up average of every axis pointing up, in 14 bit counts
+ * @param2 down average of every axis pointing down
+ * @param3 hw true to move the offset to the OFF registers
+ * @param4 solution filled with the solution
+ * @return true if every offset and gain is within the plausible range
+ */
+bool mma_calibration_solve(const int32_t up[3], const int32_t down[3], bool hw, mma_calibration_t *solution)
+{
+	bool plausible = true;
+
+	solution->reserved = 0;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		int32_t offset = up[axis] + down[axis];
+		offset = (offset >= 0) ? (offset + 1) / 2 : (offset - 1) / 2;		/*Mean, rounded*/
+		int32_t span = up[axis] - down[axis];
+		int32_t gain = (span > 0) ? (int32_t)((((2 * MMA_COUNTS_PER_G) << MMA_GAIN_SHIFT) + (span / 2)) / span) : 0;
+
+		if ((offset > MMA_CAL_MAX_OFFSET) || (offset < -MMA_CAL_MAX_OFFSET) ||
+			(gain < MMA_CAL_MIN_GAIN) || (gain > MMA_CAL_MAX_GAIN))
+		{
+			plausible = false;
+		}
+
+		int32_t hw_offset = 0;
+		if (hw)										/*The sensor adds hw_offset * 8 counts*/
+		{
+			hw_offset = (offset >= 0) ? -((offset + (MMA_OFF_COUNTS_PER_LSB / 2)) / MMA_OFF_COUNTS_PER_LSB)
+									  : ((-offset + (MMA_OFF_COUNTS_PER_LSB / 2)) / MMA_OFF_COUNTS_PER_LSB);
+		}
+		if (hw_offset > INT8_MAX)
+		{
+			hw_offset = INT8_MAX;
+		}
+		else if (hw_offset < INT8_MIN)
+		{
+			hw_offset = INT8_MIN;
+		}
+		solution->hw_offset[axis] = (int8_t)hw_offset;
+		solution->offset[axis] = (int16_t)(offset + (hw_offset * MMA_OFF_COUNTS_PER_LSB));
+		solution->gain[axis] = (uint16_t)gain;
+	}
+	return plausible;
+}
+
+/*
+ * @brief Turns the 32 frame FIFO of the accelerometer on or off
+ *
+ * @param enable true to buffer frames in the FIFO
+ * @return void
+ */
+void mma_fifo_enable(bool enable)
+{
+	mma_start();
+	mma_set_active(false);									/*F_SETUP can only be changed in standby*/
+	i2c_write_byte(MMA_ADDR, REG_F_SETUP, enable ? F_SETUP_CIRCULAR : 0x00);
+	mma_set_active(true);
+}
+
+/*
+ * @brief Reads the frames buffered in the FIFO, oldest first, in one I2C burst
+ *
+ * With the FIFO on, the register address wraps from the last data register back to
+ * REG_XHI, so a burst read of 6 bytes per frame drains the frames
+ *
+ * @param1 frames filled with X, Y and Z of every frame in 14 bit counts
+ * @param2 max size of frames, up to MMA_FIFO_SIZE
+ * @param3 overflow set if frames were lost since the last read
+ * @return number of frames read
+ */
+int mma_read_fifo(int16_t frames[][3], int max, bool *overflow)
+{
+	uint8_t status = i2c_read_byte(MMA_ADDR, REG_STATUS);
+	int count = status & F_STATUS_CNT_MASK;
+	*overflow = (status & F_STATUS_OVF) != 0;
+	if (count > max)
+	{
+		count = max;
+	}
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	i2c_start();
+	i2c_read_setup(MMA_ADDR, REG_XHI);
+	for (int frame = 0; frame < count; frame++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			bool last = (frame == count - 1) && (axis == 2);
+			uint8_t high = i2c_repeated_read(0);
+			uint8_t low = i2c_repeated_read(last);
+			frames[frame][axis] = ((int16_t)((high << 8) | low)) / 4;	/*14 bits alignment*/
+		}
+	}
+	return count;
+}
+
+/*
+ * @brief Funciton to get the roll
+ *
+ * @return roll value
+ */
+
+int get_roll()
+{
+	int16_t temp[3];
+	int roll=0;
+	PROF_BEGIN(PROF_GET_ROLL);
+	cpu_task_t previous = cpu_task_enter(CPU_TASK_SAMPLING);
+	LAT_STAMP(LAT_I2C_START);
+	PROBE_HIGH(PROBE_I2C_READ);
+	mma_read_xyz(temp);
+	PROBE_LOW(PROBE_I2C_READ);
+	LAT_STAMP(LAT_FRAME_RECEIVED);
+	PROBE_HIGH(PROBE_ANGLE);
+	mma_correct(temp);
 
-	acc_X = temp[0]/4;
-	acc_Y = temp[1]/4;								/*14 bits alignment*/
-	acc_Z = temp[2]/4;
+	acc_X = temp[0];
+	acc_Y = temp[1];
+	acc_Z = temp[2];
 
 	 float ay = acc_Y/COUNTS_PER_G,
 		   az = acc_Z/COUNTS_PER_G;
 
+	PROF_BEGIN(PROF_ATAN2);
 	roll = atan2(ay, az)*180/M_PI;				/*Formula to calculte roll*/
+	PROF_END(PROF_ATAN2);
+	PROBE_LOW(PROBE_ANGLE);
+	LAT_STAMP(LAT_ANGLE_COMPUTED);
+	cpu_task_exit(previous);
+	PROF_END(PROF_GET_ROLL);
 	return roll;
 
 
@@ -14,13 +14,66 @@
 #define MMA8451_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #define MMA_ADDR 0x3A
+#define REG_STATUS 0x00
 #define REG_XHI 0x01
+#define REG_F_SETUP 0x09
+#define REG_WHO_AM_I 0x0D
+#define REG_XYZ_DATA_CFG 0x0E
 #define REG_CTRL1  0x2A
+#define REG_CTRL2  0x2B
+#define REG_OFF_X  0x2F					/*OFF_Y and OFF_Z follow*/
+
+#define STATUS_ZYXDR 0x08					/*New frame of all three axes*/
+#define F_STATUS_OVF 0x80					/*FIFO overflowed, the oldest frames were lost*/
+#define F_STATUS_CNT_MASK 0x3F				/*Frames in the FIFO*/
+#define F_SETUP_CIRCULAR 0x40				/*FIFO keeps the newest frames*/
+#define XYZ_DATA_CFG_FS_2G 0x00
+#define XYZ_DATA_CFG_FS_4G 0x01
+#define CTRL1_ACTIVE 0x01
+#define CTRL2_ST 0x80						/*Self-test enable*/
+#define MMA_WHO_AM_I_VALUE 0x1A				/*MMA8451Q device identifier*/
+
+#define MMA_ST_DELTA_X 44					/*Typical self-test output change, 4g mode 14 bit counts*/
+#define MMA_ST_DELTA_Y 61
+#define MMA_ST_DELTA_Z 392
+#define MMA_SELF_TEST_FRAMES 16				/*Frames averaged with self-test off and on*/
+#define MMA_SELF_TEST_SETTLE_FRAMES 4		/*Frames dropped after every mode change*/
+#define MMA_FRAME_TIMEOUT_MS 10				/*A frame is due every 1.25 ms at 800 Hz*/
+#define MMA_FIFO_SIZE 32					/*Frames, 40 ms at 800 Hz*/
+#define MMA_ODR_PERIOD_US 1250				/*800 Hz*/
 #define COUNTS_PER_G (4096.0)
+#define MMA_COUNTS_PER_G 4096				/*14 bit counts in 2g mode*/
+#define MMA_OFF_COUNTS_PER_LSB 8			/*An OFF register LSB is 2 mg*/
+#define MMA_GAIN_SHIFT 14					/*Gains are Q14 fixed point*/
+#define MMA_GAIN_UNITY (1 << MMA_GAIN_SHIFT)
+#define MMA_CAL_MAX_OFFSET (MMA_COUNTS_PER_G / 4)	/*0.25 g, a larger bias means a bad position*/
+#define MMA_CAL_MIN_GAIN ((MMA_GAIN_UNITY * 4) / 5)
+#define MMA_CAL_MAX_GAIN ((MMA_GAIN_UNITY * 5) / 4)
 #define M_PI (3.14159265)
 
+typedef struct
+{
+	uint8_t who_am_i;
+	int32_t delta[3];						/*Self-test output change of X, Y and Z*/
+	bool passed;
+} mma_self_test_t;
+
+/*
+ * Per-axis correction, corrected = ((raw - offset) * gain) >> MMA_GAIN_SHIFT. With the
+ * hardware offset in use the OFF registers remove the bias in steps of 8 counts before
+ * the frame is read, and offset only holds the remainder
+ */
+typedef struct
+{
+	int16_t offset[3];						/*Counts subtracted in software*/
+	uint16_t gain[3];						/*Q14 scale applied after the offset*/
+	int8_t hw_offset[3];					/*Written to OFF_X, OFF_Y and OFF_Z*/
+	uint8_t reserved;
+} mma_calibration_t;
+
 
 /*
  * @brief Initializes the acclerometer
@@ -30,6 +83,16 @@
 
 int init_mma(void);
 
+/*
+ * @brief Initializes the I2C bus and the accelerometer, does nothing if already initialized
+ *
+ * Called by the first read, so the accelerometer needs no initialization at boot
+ *
+ * @return void
+ */
+
+void mma_start(void);
+
 /*
  * @brief Funciton to get the roll
  *
@@ -38,5 +101,93 @@ int init_mma(void);
 
 int get_roll();
 
+/*
+ * @brief Reads one frame of the three axes
+ *
+ * @param xyz X, Y and Z acceleration in 14 bit counts
+ * @return void
+ */
+
+void mma_read_xyz(int16_t xyz[3]);
+
+/*
+ * @brief Applies the offset and gain calibration to a frame, in integer math
+ *
+ * @param xyz X, Y and Z acceleration in 14 bit counts, corrected in place
+ * @return void
+ */
+void mma_correct(int16_t xyz[3]);
+
+/*
+ * @brief Averages frames of the three axes after letting the output settle
+ *
+ * @param average average of every axis in 14 bit counts
+ * @return true if every frame was read, false on timeout
+ */
+bool mma_average(int32_t average[3]);
+
+/*
+ * @brief Sets the calibration used by mma_correct() and the OFF registers
+ *
+ * @param calibration calibration to use, NULL for none
+ * @return void
+ */
+void mma_set_calibration(const mma_calibration_t *calibration);
+
+/*
+ * @brief Returns the calibration in use
+ *
+ * @param calibration filled with the calibration
+ * @return void
+ */
+void mma_get_calibration(mma_calibration_t *calibration);
+
+/*
+ * @brief Solves the offset and gain of every axis from the board resting on its six faces
+ *
+ * With an axis pointing up it reads +1g plus its offset, pointing down -1g plus its
+ * offset, so the offset is the mean of the two and the gain scales their difference to 2g
+ *
+ * @param1 up average of every axis pointing up, in 14 bit counts
+ * @param2 down average of every axis pointing down
+ * @param3 hw true to move the offset to the OFF registers
+ * @param4 calibration filled with the solution
+ * @return true if every offset and gain is within the plausible range
+ */
+bool mma_calibration_solve(const int32_t up[3], const int32_t down[3], bool hw, mma_calibration_t *calibration);
+
+/*
+ * @brief Electrical self-test of the accelerometer
+ *
+ * Checks WHO_AM_I, then averages frames with the self-test bit of CTRL_REG2 clear and
+ * set in 4g mode and checks the output change against the datasheet. Takes about 50 ms
+ *
+ * @param result WHO_AM_I value and the measured output change of every axis
+ * @return true if passed
+ */
+
+bool mma_self_test(mma_self_test_t *result);
+
+/*
+ * @brief Turns the 32 frame FIFO of the accelerometer on or off
+ *
+ * While the FIFO is on, mma_read_xyz() returns the oldest buffered frame, so only the
+ * owner of the FIFO should read frames
+ *
+ * @param enable true to buffer frames in the FIFO
+ * @return void
+ */
+void mma_fifo_enable(bool enable);
+
+/*
+ * @brief Reads the frames buffered in the FIFO, oldest first, in one I2C burst
+ *
+ * @param1 frames filled with X, Y and Z of every frame in 14 bit counts
+ * @param2 max size of frames, up to MMA_FIFO_SIZE
+ * @param3 overflow set if frames were lost since the last read
+ * @return number of frames read
+ */
+int mma_read_fifo(int16_t frames[][3], int max, bool *overflow);
+
 
 #endif /* MMA8451_H_ */
@@ -0,0 +1,115 @@
+/**
+ * @file    blog.c
+ * @brief   This source file consists of function definitions of the binary log ring
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ */
+
+#include <stdio.h>
+#include "MKL25Z4.h"
+#include "blog.h"
+#include "timer.h"
+#include "uart.h"
+#include "critical.h"
+
+#define RING_MASK (BLOG_ENTRIES - 1)
+
+#if BLOG_ENABLE
+
+static blog_entry_t ring[BLOG_ENTRIES];
+static volatile uint32_t head = 0;			/*Oldest entry*/
+static volatile uint32_t tail = 0;			/*Next entry written*/
+static volatile uint32_t overwritten = 0;
+
+
+/*
+ * @brief Adds an entry to the ring, called by the BLOGn() macros
+ *
+ * The entry is filled with interrupts masked, so a handler logging meanwhile gets the
+ * next slot
+ *
+ * @param1 id format string address with the argument count in the low bits
+ * @param2-5 a, b, c, d argument words, unused ones are 0
+ * @return void
+ */
+void blog_write(uint32_t id, uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+{
+	crit_state_t masking_state = crit_enter(CRIT_BLOG);
+	blog_entry_t *entry = &ring[tail & RING_MASK];
+	entry->id = id;
+	entry->cycles = timebase_tick_cycles(&entry->ticks);
+	entry->args[0] = a;
+	entry->args[1] = b;
+	entry->args[2] = c;
+	entry->args[3] = d;
+	tail++;
+	if ((tail - head) > BLOG_ENTRIES)
+	{
+		head++;
+		overwritten++;
+	}
+	crit_exit(CRIT_BLOG, masking_state);
+}
+
+/*
+ * @brief Sends the entries, oldest first, as a text line followed by the raw entries
+ *
+ * @return void
+ */
+void blog_dump(void)
+{
+	blog_entry_t entry;
+	crit_state_t masking_state = crit_enter(CRIT_BLOG);
+	uint32_t count = tail - head;
+	uint32_t lost = overwritten;
+	overwritten = 0;
+	crit_exit(CRIT_BLOG, masking_state);
+
+	printf("BLOG %lu %lu %lu\n\r", (unsigned long)count, (unsigned long)timebase_cycles_per_tick(),
+			(unsigned long)lost);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		masking_state = crit_enter(CRIT_BLOG);	/*Entries logged while dumping are kept for the next dump*/
+		entry = ring[head & RING_MASK];
+		head++;
+		crit_exit(CRIT_BLOG, masking_state);
+		uart0_write(&entry, sizeof(entry));
+	}
+	printf("\n\rBLOG END\n\r");
+}
+
+/*
+ * @brief Prints the number of entries waiting and overwritten
+ *
+ * @return void
+ */
+void blog_report(void)
+{
+	printf("%lu of %d entries waiting, %lu overwritten, type blog dump to read them\n\r",
+			(unsigned long)(tail - head), BLOG_ENTRIES, (unsigned long)overwritten);
+}
+
+#else
+
+/*
+ * @brief Sends the entries, oldest first, as a text line followed by the raw entries
+ *
+ * @return void
+ */
+void blog_dump(void)
+{
+	printf("Binary log is not enabled in this build\n\r");
+}
+
+/*
+ * @brief Prints the number of entries waiting and overwritten
+ *
+ * @return void
+ */
+void blog_report(void)
+{
+	printf("Binary log is not enabled in this build\n\r");
+}
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * @file    blog.h
+ * @brief   This header file consists of the logging macros and function prototypes of the
+ * 			binary log, which records messages without formatting them on the target
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * BLOGn(fmt, ...) stores the address of its format string as the message ID, a timestamp
+ * and n raw argument words in a ring buffer; the oldest entries are overwritten. The
+ * timestamp is the 1 ms tick count and the cycles within the tick, so rare messages far
+ * apart still decode to the right elapsed time, up to ~49 days.
+ * The format strings are kept together in the .rodata.blog section of the image, never
+ * read by the target. tools/blogdecode.py rebuilds the text from the ELF file and the
+ * output of the blog dump command. A message costs a few tens of cycles and may be logged
+ * from interrupt handlers.
+ *
+ * Arguments are stored as 32 bit words, so the format may use %d, %u, %x, %c and the l
+ * modifier; %s must point to a constant string in flash, which the decoder reads from the
+ * ELF file. Enabled in Debug builds, define BLOG_ENABLE as 0 or 1 to override.
+ */
+
+#ifndef BLOG_H_
+#define BLOG_H_
+
+#include <stdint.h>
+
+#if !defined(BLOG_ENABLE)
+#if defined(DEBUG)
+#define BLOG_ENABLE 1
+#else
+#define BLOG_ENABLE 0
+#endif
+#endif
+
+#define BLOG_ENTRIES 64						/*Power of 2*/
+#define BLOG_MAX_ARGS 4
+#define BLOG_ID_ALIGN 8						/*The low 3 bits of the ID hold the argument count*/
+
+typedef struct
+{
+	uint32_t id;							/*Format string address | argument count*/
+	uint32_t ticks;							/*timebase_tick_cycles()*/
+	uint32_t cycles;						/*Core cycles since the start of the tick*/
+	uint32_t args[BLOG_MAX_ARGS];
+} blog_entry_t;
+
+#if BLOG_ENABLE
+
+#define BLOG_ID(fmt)						\
+	({										\
+		static const char blog_fmt[] __attribute__((section(".rodata.blog"), aligned(BLOG_ID_ALIGN))) = fmt; \
+		(uint32_t)blog_fmt;					\
+	})
+
+#define BLOG0(fmt)					blog_write(BLOG_ID(fmt) | 0, 0, 0, 0, 0)
+#define BLOG1(fmt, a)				blog_write(BLOG_ID(fmt) | 1, (uint32_t)(a), 0, 0, 0)
+#define BLOG2(fmt, a, b)			blog_write(BLOG_ID(fmt) | 2, (uint32_t)(a), (uint32_t)(b), 0, 0)
+#define BLOG3(fmt, a, b, c)			blog_write(BLOG_ID(fmt) | 3, (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), 0)
+#define BLOG4(fmt, a, b, c, d)		blog_write(BLOG_ID(fmt) | 4, (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d))
+
+/*
+ * @brief Adds an entry to the ring, called by the BLOGn() macros
+ *
+ * @param1 id format string address with the argument count in the low bits
+ * @param2-5 a, b, c, d argument words, unused ones are 0
+ * @return void
+ */
+void blog_write(uint32_t id, uint32_t a, uint32_t b, uint32_t c, uint32_t d);
+
+#else
+
+#define BLOG0(fmt)
+#define BLOG1(fmt, a)
+#define BLOG2(fmt, a, b)
+#define BLOG3(fmt, a, b, c)
+#define BLOG4(fmt, a, b, c, d)
+
+#endif
+
+/*
+ * @brief Sends the entries, oldest first, as a text line followed by the raw entries
+ *
+ * The line is "BLOG <entries> <cycles per tick> <overwritten>", then every entry as a
+ * little-endian blog_entry_t. The ring is emptied
+ *
+ * @return void
+ */
+void blog_dump(void);
+
+/*
+ * @brief Prints the number of entries waiting and overwritten
+ *
+ * @return void
+ */
+void blog_report(void);
+
+#endif /* BLOG_H_ */
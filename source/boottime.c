@@ -0,0 +1,84 @@
+/**
+ * @file    boottime.c
+ * @brief   This source file consists of function definitions of the boot timeline
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ */
+
+#include <stdio.h>
+#include "boottime.h"
+
+typedef struct
+{
+	const char *name;
+	uint64_t start_cycles;
+	uint64_t cycles;
+} boot_step_t;
+
+static boot_step_t steps[BOOTTIME_MAX_STEPS];
+static int num_steps = 0;
+static int dropped_steps = 0;
+
+
+/*
+ * @brief Converts a 64 bit cycle count in to microseconds
+ *
+ * @param cycles core clock cycles
+ * @return microseconds
+ */
+static uint32_t cycles_to_us(uint64_t cycles)
+{
+	return (uint32_t)timebase_cycles64_to_us(cycles);
+}
+
+/*
+ * @brief Records a step of the timeline which started at start_cycles and ends now
+ *
+ * @param1 name name of the step, must be a string constant
+ * @param2 start_cycles timebase_cycles64() when the step started
+ * @return void
+ */
+void boottime_record(const char *name, uint64_t start_cycles)
+{
+	uint64_t now = timebase_cycles64();
+	if (num_steps >= BOOTTIME_MAX_STEPS)
+	{
+		dropped_steps++;
+		return;
+	}
+	steps[num_steps].name = name;
+	steps[num_steps].start_cycles = start_cycles;
+	steps[num_steps].cycles = now - start_cycles;
+	num_steps++;
+}
+
+/*
+ * @brief Records a point of the timeline, such as the first prompt
+ *
+ * @param name name of the point, must be a string constant
+ * @return void
+ */
+void boottime_mark(const char *name)
+{
+	boottime_record(name, timebase_cycles64());
+}
+
+/*
+ * @brief Prints the timeline with the start and duration of every step
+ *
+ * @return void
+ */
+void boottime_report(void)
+{
+	printf("Start(us)\tTime(us)\tStep\n\r");
+	for (int step = 0; step < num_steps; step++)
+	{
+		printf("%lu\t\t%lu\t\t%s\n\r", (unsigned long)cycles_to_us(steps[step].start_cycles),
+				(unsigned long)cycles_to_us(steps[step].cycles), steps[step].name);
+	}
+	if (dropped_steps != 0)
+	{
+		printf("%d steps not recorded, increase BOOTTIME_MAX_STEPS\n\r", dropped_steps);
+	}
+}
@@ -0,0 +1,59 @@
+/**
+ * @file    boottime.h
+ * @brief   This header file consists of the step timing macro and function prototypes of
+ * 			the boot timeline
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * Every initialization step is timed with the timebase, so the timeline starts when the
+ * systick is started, right after the clock switch. Steps done lazily after the prompt
+ * are recorded when they run, their start time shows how late that was.
+ */
+
+#ifndef BOOTTIME_H_
+#define BOOTTIME_H_
+
+#include <stdint.h>
+#include "timer.h"
+
+#define BOOTTIME_MAX_STEPS 16
+
+/*
+ * Runs call and records it as a step of the timeline
+ */
+#define BOOT_STEP(name, call)								\
+	do														\
+	{														\
+		uint64_t boot_step_start = timebase_cycles64();		\
+		call;												\
+		boottime_record((name), boot_step_start);			\
+	} while (0)
+
+
+/*
+ * @brief Records a step of the timeline which started at start_cycles and ends now
+ *
+ * @param1 name name of the step, must be a string constant
+ * @param2 start_cycles timebase_cycles64() when the step started
+ * @return void
+ */
+void boottime_record(const char *name, uint64_t start_cycles);
+
+/*
+ * @brief Records a point of the timeline, such as the first prompt
+ *
+ * @param name name of the point, must be a string constant
+ * @return void
+ */
+void boottime_mark(const char *name);
+
+/*
+ * @brief Prints the timeline with the start and duration of every step
+ *
+ * @return void
+ */
+void boottime_report(void);
+
+
+#endif /* BOOTTIME_H_ */
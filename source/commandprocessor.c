@@ -19,18 +19,93 @@
 #include "switch.h"
 #include "LEDs.h"
 #include "accelerometer.h"
+#include "swtimer.h"
+#include "profiler.h"
+#include "latency.h"
+#include "idle.h"
+#include "guidance.h"
+#include "uart.h"
+#include "events.h"
+#include "deferred.h"
+#include "selftest.h"
+#include "boottime.h"
+#include "sysclock.h"
+#include "ramfunc.h"
+#include "settings.h"
+#include "logger.h"
+#include "blog.h"
+#include "fmt.h"
+#include "trace.h"
+#include "mem.h"
+#include "critical.h"
+#include "irqstat.h"
 
 #define MINIMUM_ANGLE 0				/*Maximum and minimum angle that can be shared*/
 #define MAXIMUM_ANGLE 180
 #define DEGREE_90      90
-#define MAX_INTENSITY 0xFF
 #define GREEN 0xFF
 #define RED   0xFF
 #define BLUE  0xFF
 #define OFF 	 0
+#define GUIDANCE_FADE_MS 20			/*Transition time of the guidance colour, 10 PWM periods*/
+#define SAMPLE_PERIOD_MS 10			/*Accelerometer sampling period of the set command*/
+#define NO_ANGLE        (-1)
 
 typedef void (*command_handler_t)(int, char *argv[]);
 
+typedef enum
+{
+	JOB_RUNNING = 0,				/*Step again on the next wake event*/
+	JOB_DONE
+} job_status_t;
+
+typedef struct						/*A long-running command, stepped by the event it waits for*/
+{
+	const char *name;
+	event_t wake;					/*Event which runs the next step*/
+	job_status_t (*step)(void);
+	void (*cancel)(void);
+	void (*status)(void);
+} command_job_t;
+
+static job_status_t calibrate_step(void);
+static void calibrate_cancel(void);
+static void calibrate_status(void);
+static job_status_t set_angle_step(void);
+static void set_angle_cancel(void);
+static void set_angle_status(void);
+static job_status_t log_step(void);
+static void log_cancel(void);
+static void log_status(void);
+static job_status_t sensorcal_step(void);
+static void sensorcal_cancel(void);
+static void sensorcal_status(void);
+
+static void post_sample(void *arg);
+
+static const command_job_t calibrate_job = {"calibrate", EVENT_SWITCH, calibrate_step, calibrate_cancel, calibrate_status};
+static const command_job_t set_angle_job = {"set", EVENT_SAMPLE, set_angle_step, set_angle_cancel, set_angle_status};
+static const command_job_t log_job = {"log", EVENT_SAMPLE, log_step, log_cancel, log_status};
+static const command_job_t sensorcal_job = {"sensorcal", EVENT_SWITCH, sensorcal_step, sensorcal_cancel, sensorcal_status};
+static const command_job_t *active_job = NULL;	/*Command in progress, NULL when the console is free*/
+static swtimer_t sample_timer;				/*Posts EVENT_SAMPLE while a job samples the accelerometer*/
+
+static int set_input_angle = 0;				/*State of the set command in progress*/
+static int set_measure_angle = 0;
+static int set_last_angle = 0;				/*Angle the guidance colour was last computed for*/
+
+#define SENSORCAL_POSITIONS 6
+#define SENSORCAL_ALL ((1 << SENSORCAL_POSITIONS) - 1)
+#define SENSORCAL_MIN_G ((MMA_COUNTS_PER_G * 3) / 4)		/*The axis pointing up or down reads at least 0.75 g*/
+#define SENSORCAL_MAX_TILT (MMA_COUNTS_PER_G / 4)		/*and the other two at most 0.25 g*/
+
+static const char *const sensorcal_names[SENSORCAL_POSITIONS] = {"X up", "X down", "Y up", "Y down", "Z up", "Z down"};
+static int32_t sensorcal_up[3];				/*State of the sensorcal command in progress*/
+static int32_t sensorcal_down[3];
+static uint8_t sensorcal_done = 0;			/*Bit per captured position, in the order of sensorcal_names*/
+static bool sensorcal_hw = false;
+static mma_calibration_t sensorcal_previous;	/*Restored if the command is cancelled*/
+
 int reference = 0;
 int maximum_angle = 180;
 typedef struct
@@ -42,148 +117,925 @@ typedef struct
 
 
 static const command_table_t commands[] ={{"author",handle_author,"1. Type <Author>(case insensitive) to know the author's name \n\r"},
-										  {"calibrate",handle_calibrate,"2. Type <calibrate> to set a reference position as 0 with respect to which angle wll be measured\n\r"},
-										  {"help",handle_help,"3. Type <help>(case insensitive) to know about the possible commands\n\r"},
-										  {"info",handle_info,"4. Type <info>(case insensitive) to know about the build information\n\r"},
-										  {"set", handle_set_angle,"5. Type <set> followed by <angle> to measure angle with respect to the reference position you have given\n\r"}};
+										  {"blog",handle_blog,"2. Type <blog> to know how many binary log messages are waiting, <blog dump> to send them for tools/blogdecode.py\n\r"},
+										  {"boot",handle_boot,"3. Type <boot> to know the boot mode and cached self-test results, <boot> followed by <full>, <quick> or <skip> to change the boot mode\n\r"},
+										  {"calibrate",handle_calibrate,"4. Type <calibrate> to set a reference position as 0 with respect to which angle wll be measured\n\r"},
+										  {"cancel",handle_cancel,"5. Type <cancel> to stop a calibrate, set, log or sensorcal command in progress\n\r"},
+										  {"cpu",handle_cpu,"6. Type <cpu> to know the CPU load and the time taken by each task over the last second\n\r"},
+										  {"crit",handle_crit,"7. Type <crit> to print and reset how long each critical section kept the interrupts masked\n\r"},
+										  {"events",handle_events,"8. Type <events> to know how often each event and interrupt bottom half ran and its worst latency\n\r"},
+										  {"help",handle_help,"9. Type <help>(case insensitive) to know about the possible commands\n\r"},
+										  {"info",handle_info,"10. Type <info>(case insensitive) to know about the build information\n\r"},
+										  {"irq",handle_irq,"11. Type <irq> to print and reset the entries, run time and entry latency of every interrupt with its effective priority\n\r"},
+										  {"lat", handle_latency,"12. Type <lat> to print and reset the tilt-to-LED latency of the set command\n\r"},
+										  {"log",handle_log,"13. Type <log> followed by <start>, <stop>, <dump>, <erase> or <status> to record accelerometer frames to flash and read them back\n\r"},
+										  {"mem",handle_mem,"14. Type <mem> to know how the SRAM is used and the deepest the stack has been\n\r"},
+										  {"prof", handle_prof,"15. Type <prof> to print and reset the per-function cycle profile\n\r"},
+										  {"ram",handle_ram,"16. Type <ram> to know the SRAM used by the RAM-resident functions and the cycles they save over flash\n\r"},
+										  {"sensorcal",handle_sensorcal,"17. Type <sensorcal> or <sensorcal hw> to calibrate the accelerometer offset and gain on the six faces of the board, <sensorcal show> or <sensorcal clear> for the one in use\n\r"},
+										  {"set", handle_set_angle,"18. Type <set> followed by <angle> to measure angle with respect to the reference position you have given\n\r"},
+										  {"status", handle_status,"19. Type <status> to know the progress of a calibrate, set, log or sensorcal command\n\r"},
+										  {"store",handle_store,"20. Type <store> to know the state of the flash key/value store holding the settings and the reference\n\r"},
+										  {"test",handle_test,"21. Type <test> to run every self-test now, including the ones needing the switch and board tilts\n\r"},
+										  {"timeline",handle_timeline,"22. Type <timeline> to know how long each boot step took and when the lazy peripherals started\n\r"},
+										  {"timers", handle_timers,"23. Type <timers> to list the running software timers with their period and jitter\n\r"},
+										  {"trace",handle_trace,"24. Type <trace> followed by <start>, <stop> or <dump> to record the branches taken by the core, <trace step> followed by a command such as <set> to record one step of it, <trace size> followed by <bytes> to change the buffer used\n\r"}};
 
 
 
 static const int num_commands = sizeof(commands) / sizeof(command_table_t);
 
 
-char buffer1[200];   /*Buffer used to take input from the character*/
+char buffer1[INPUT_BUFFER_SIZE];   /*Buffer used to take input from the character*/
 int i=0;			 /*To store the buffer index*/
 
 
 /*
- * @brief Handler function for help command
+ * @brief Handler function for help command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_help(int argc, char *argv[])
+{
+	if(argc!=1)
+	{
+		printf("Wrong Syntax! Refer Help for Help syntax\n\r"); /*Checking the number of tokens*/
+		return;
+	}
+	for(int i=0;i<num_commands;i++)
+	{
+		printf(commands[i].help_string);
+	}
+
+}
+
+/*
+ * @brief To check whether a long-running command is in progress
+ *
+ * @return true if a calibrate, set, log or sensorcal command is in progress
+ */
+bool command_busy(void)
+{
+	return active_job != NULL;
+}
+
+/*
+ * @brief Prints the prompt, unless a long-running command is in progress
+ *
+ * @return void
+ */
+static void prompt_if_free(void)
+{
+	if (active_job == NULL)
+	{
+		printf("? ");
+	}
+}
+
+/*
+ * @brief Sample timer callback, asks for the next step of the sampling command
+ *
+ * The accelerometer has no data ready interrupt wired, so the samples are paced by a
+ * software timer. The event is the same one a data ready interrupt would post
+ *
+ * @param arg unused
+ * @return void
+ */
+static void post_sample(void *arg)
+{
+	event_post(EVENT_SAMPLE);
+}
+
+/*
+ * @brief Makes a long-running command the one stepped by its wake event
+ *
+ * @param job the command to run
+ * @return void
+ */
+static void start_job(const command_job_t *job)
+{
+	active_job = job;
+	if (job->wake == EVENT_SAMPLE)
+	{
+		swtimer_periodic(&sample_timer, "sample", SAMPLE_PERIOD_MS, post_sample, NULL);
+		event_post(EVENT_SAMPLE);					/*First sample straight away*/
+	}
+}
+
+/*
+ * @brief Frees the console once the long-running command is done or cancelled
+ *
+ * @return void
+ */
+static void end_job(void)
+{
+	swtimer_stop(&sample_timer);
+	active_job = NULL;
+}
+
+/*
+ * @brief Refuses to start a long-running command while another one is in progress
+ *
+ * @return true if the caller must not start its command
+ */
+static bool reject_if_busy(void)
+{
+	if (active_job != NULL)
+	{
+		printf("%s is in progress, type cancel to stop it or status to check on it\n\r", active_job->name);
+		return true;
+	}
+	return false;
+}
+
+/*
+ * @brief Stores the reference so it survives a reset
+ *
+ * @return void
+ */
+static void save_calibration(void)
+{
+	calibration_t calibration = {(int16_t)reference, (int16_t)maximum_angle};
+	if (!calibration_save(&calibration))
+	{
+		printf("The reference could not be stored, it will be lost at reset\n\r");
+	}
+}
+
+/*
+ * @brief Calibrate step, sets the reference once the switch is pressed
+ *
+ * @return JOB_RUNNING until the switch is pressed, then JOB_DONE
+ */
+static job_status_t calibrate_step(void)
+{
+	if (! check_switch_pressed())
+	{
+		return JOB_RUNNING;
+	}
+	reference = abs(get_roll());
+	if (reference < DEGREE_90)										/*Checking whether reference is above or below 90*/
+	{
+		maximum_angle =  MAXIMUM_ANGLE - reference;					/*maximum angle that can be measured post zero reference*/
+		printf("\n\rSwitch is pressed, Reference zero angle is set as %d, Use this to measure the angle you require\n\r", reference);
+		printf("\n\rWith this zero reference , you can measure up to %d\n\r",maximum_angle);
+		save_calibration();
+		update_led_colour(OFF, GREEN, OFF);
+	}
+	else if (reference > DEGREE_90)
+	{
+		printf("The reference zero can only be set between 0 to 90, type calibrate to again set zero reference\n\r");
+	}
+	return JOB_DONE;
+}
+
+/*
+ * @brief Stops a calibrate command in progress, the reference is left unchanged
+ *
+ * @return void
+ */
+static void calibrate_cancel(void)
+{
+	update_led_colour(OFF, OFF, OFF);
+	printf("Calibration cancelled, reference zero is still %d\n\r", reference);
+}
+
+/*
+ * @brief Prints the progress of a calibrate command
+ *
+ * @return void
+ */
+static void calibrate_status(void)
+{
+	fmt_printf("Waiting for the switch press to set the reference zero, current roll %d\n\r", abs(get_roll()));
+}
+
+/*
+ * @brief Handler function for calibrate command
+ *
+ * Starts the calibration, which completes on the switch press event
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_calibrate(int argc, char *argv[])
+{
+	if(argc!=1)
+	{
+		printf("Wrong Syntax! Refer Help for calibrate syntax\n\r");
+		return;
+	}
+	if (reject_if_busy())
+	{
+		return;
+	}
+	update_led_colour(RED, OFF, OFF);
+	printf("Move the board to reference zero and press switch to set the position\n\r");
+	reset_switch();
+	start_job(&calibrate_job);
+}
+
+/*
+ * @brief Set angle step, takes one sample and updates the guidance colour
+ *
+ * @return JOB_RUNNING while the angle is not reached, then JOB_DONE
+ */
+static job_status_t set_angle_step(void)
+{
+	const guidance_colour_t *colour;				/*Gamma corrected Red, Green, Blue to be loaded in TPM registers*/
+	int angle_zero = abs(get_roll());				/*One frame per iteration, both angles from the same sample*/
+
+	set_measure_angle = angle_zero - reference ;
+	if (angle_zero == set_last_angle)				/*Guidance level unchanged, the LED engine keeps the colour*/
+	{
+		return JOB_RUNNING;
+	}
+	set_last_angle = angle_zero;
+	if (set_measure_angle == set_input_angle)
+	{
+		LAT_STAMP(LAT_COMPARE_DONE);
+		led_fade_to(RED, OFF, OFF, GUIDANCE_FADE_MS);
+		fmt_str("Desired angle is reached\n\r");
+		reference = 0;
+		save_calibration();								/*A reset must not bring the old reference back*/
+		fmt_str("Type calibrate if you want to set reference position before measuring another angle\n\r");
+		fmt_printf("Current Reference Angle = %d\n\r",reference);
+		return JOB_DONE;
+	}
+	else if((angle_zero <= reference) && (reference !=0))				/*When angle is far away from the destination angle*/
+	{
+		colour = guidance_colour(GUIDANCE_FAR, angle_zero, reference); /*Blue turning green on the way to the reference*/
+		LAT_STAMP(LAT_COMPARE_DONE);
+		led_fade_to(colour->red, colour->green, colour->blue, GUIDANCE_FADE_MS);
+	}
+	else if((set_measure_angle <= reference) || (reference == 0))		/*When angle is close to the destination angle*/
+	{
+		colour = guidance_colour(GUIDANCE_CLOSE, set_measure_angle, set_input_angle); /*Green turning red as the angle gets closer*/
+		LAT_STAMP(LAT_COMPARE_DONE);
+		led_fade_to(colour->red, colour->green, colour->blue, GUIDANCE_FADE_MS);
+	}
+	return JOB_RUNNING;
+}
+
+/*
+ * @brief Stops a set angle command in progress
+ *
+ * @return void
+ */
+static void set_angle_cancel(void)
+{
+	update_led_colour(OFF, OFF, OFF);
+	fmt_printf("Measurement cancelled at %d degrees of the requested %d\n\r", set_measure_angle, set_input_angle);
+}
+
+/*
+ * @brief Prints the progress of a set angle command
+ *
+ * @return void
+ */
+static void set_angle_status(void)
+{
+	fmt_printf("Measuring: requested %d, current %d, reference zero %d\n\r", set_input_angle, set_measure_angle, reference);
+}
+
+/*
+ * @brief Handler function for ram command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_ram(int argc, char *argv[])
+{
+	if(argc!=1)
+	{
+		printf("Wrong Syntax! Refer Help for ram syntax\n\r");
+		return;
+	}
+	ramfunc_report();
+}
+
+/*
+ * @brief Log step, drains the accelerometer FIFO in to the flash log
+ *
+ * @return JOB_RUNNING until the log is full, then JOB_DONE
+ */
+static job_status_t log_step(void)
+{
+	if (logger_poll())
+	{
+		return JOB_RUNNING;
+	}
+	printf("The log is full, recording stopped\n\r");
+	return JOB_DONE;
+}
+
+/*
+ * @brief Stops the recording, the frames logged so far are kept
+ *
+ * @return void
+ */
+static void log_cancel(void)
+{
+	logger_stop();
+	printf("Recording stopped\n\r");
+}
+
+/*
+ * @brief Prints the progress of the recording
+ *
+ * @return void
+ */
+static void log_status(void)
+{
+	logger_report();
+}
+
+/*
+ * @brief Handler function for log command
+ *
+ * <log start> records accelerometer frames to flash until <log stop> or the log is full,
+ * <log dump> sends the log in binary, <log erase> empties it and <log> prints its state
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_log(int argc, char *argv[])
+{
+	if(argc == 1)
+	{
+		logger_report();
+		return;
+	}
+	if(argc != 2)
+	{
+		printf("Wrong Syntax! Refer Help for log syntax\n\r");
+		return;
+	}
+	if(strcasecmp(argv[1], "stop") == 0)
+	{
+		if (active_job != &log_job)
+		{
+			printf("Not recording\n\r");
+			return;
+		}
+		log_cancel();
+		end_job();
+		return;
+	}
+	if(strcasecmp(argv[1], "status") == 0)
+	{
+		logger_report();
+		return;
+	}
+	if(reject_if_busy())
+	{
+		return;
+	}
+	if(strcasecmp(argv[1], "start") == 0)
+	{
+		if (!logger_start())
+		{
+			printf("The log is full or holds foreign data, type log erase first\n\r");
+			return;
+		}
+		printf("Recording, type log stop to end\n\r");
+		start_job(&log_job);
+	}
+	else if(strcasecmp(argv[1], "erase") == 0)
+	{
+		printf(logger_erase() ? "Log erased\n\r" : "The log could not be erased\n\r");
+	}
+	else if(strcasecmp(argv[1], "dump") == 0)
+	{
+		logger_dump();
+	}
+	else
+	{
+		printf("Wrong Syntax! Refer Help for log syntax\n\r");
+	}
+}
+
+/*
+ * @brief Prints the positions still to be captured by the sensorcal command
+ *
+ * @return void
+ */
+static void sensorcal_print_remaining(void)
+{
+	printf("Rest the board on a face and press the switch, remaining:");
+	for (int position = 0; position < SENSORCAL_POSITIONS; position++)
+	{
+		if ((sensorcal_done & (1 << position)) == 0)
+		{
+			printf(" %s", sensorcal_names[position]);
+		}
+	}
+	printf("\n\r");
+}
+
+/*
+ * @brief Prints the offset and gain of every axis
+ *
+ * @param calibration calibration to print
+ * @return void
+ */
+static void sensorcal_print(const mma_calibration_t *calibration)
+{
+	static const char axis_names[3] = {'X', 'Y', 'Z'};
+	for (int axis = 0; axis < 3; axis++)
+	{
+		uint32_t gain = ((uint32_t)calibration->gain[axis] * 10000 + (MMA_GAIN_UNITY / 2)) >> MMA_GAIN_SHIFT;
+		fmt_printf("%c: offset %d counts (%d in OFF register), gain ", axis_names[axis],
+				calibration->offset[axis] - (calibration->hw_offset[axis] * MMA_OFF_COUNTS_PER_LSB),
+				calibration->hw_offset[axis]);
+		fmt_fixed((int32_t)gain, 4);
+		fmt_str("\n\r");
+	}
+}
+
+/*
+ * @brief Sensorcal step, captures the position the board rests in on every switch press
+ *
+ * @return JOB_RUNNING until all six positions are captured, then JOB_DONE
+ */
+static job_status_t sensorcal_step(void)
+{
+	int32_t average[3];
+	int axis = 0;
+
+	if (! check_switch_pressed())
+	{
+		return JOB_RUNNING;
+	}
+	if (!mma_average(average))
+	{
+		printf("The accelerometer did not respond, press the switch to retry\n\r");
+		return JOB_RUNNING;
+	}
+	for (int other = 1; other < 3; other++)
+	{
+		if (abs(average[other]) > abs(average[axis]))
+		{
+			axis = other;
+		}
+	}
+	bool level = abs(average[axis]) >= SENSORCAL_MIN_G;
+	for (int other = 0; other < 3; other++)
+	{
+		level = level && ((other == axis) || (abs(average[other]) <= SENSORCAL_MAX_TILT));
+	}
+	if (!level)
+	{
+		printf("The board is not resting on a face (X %ld, Y %ld, Z %ld), press the switch to retry\n\r",
+				(long)average[0], (long)average[1], (long)average[2]);
+		return JOB_RUNNING;
+	}
+
+	int position = (axis * 2) + ((average[axis] < 0) ? 1 : 0);
+	if (sensorcal_done & (1 << position))
+	{
+		printf("%s is already captured\n\r", sensorcal_names[position]);
+		sensorcal_print_remaining();
+		return JOB_RUNNING;
+	}
+	if (average[axis] < 0)
+	{
+		sensorcal_down[axis] = average[axis];
+	}
+	else
+	{
+		sensorcal_up[axis] = average[axis];
+	}
+	sensorcal_done |= (1 << position);
+	printf("Captured %s: %ld counts\n\r", sensorcal_names[position], (long)average[axis]);
+	if (sensorcal_done != SENSORCAL_ALL)
+	{
+		sensorcal_print_remaining();
+		return JOB_RUNNING;
+	}
+
+	mma_calibration_t calibration;
+	if (!mma_calibration_solve(sensorcal_up, sensorcal_down, sensorcal_hw, &calibration))
+	{
+		mma_set_calibration(&sensorcal_previous);
+		printf("Calibration rejected, an offset or gain is out of range. The previous one is kept\n\r");
+		sensorcal_print(&calibration);
+		return JOB_DONE;
+	}
+	mma_set_calibration(&calibration);
+	printf("Calibration applied:\n\r");
+	sensorcal_print(&calibration);
+	if (!sensor_calibration_save(&calibration))
+	{
+		printf("The calibration could not be stored, it will be lost at reset\n\r");
+	}
+	return JOB_DONE;
+}
+
+/*
+ * @brief Stops a sensorcal command in progress, the previous calibration is restored
+ *
+ * @return void
+ */
+static void sensorcal_cancel(void)
+{
+	mma_set_calibration(&sensorcal_previous);
+	printf("Sensor calibration cancelled, the previous one is restored\n\r");
+}
+
+/*
+ * @brief Prints the progress of a sensorcal command
+ *
+ * @return void
+ */
+static void sensorcal_status(void)
+{
+	sensorcal_print_remaining();
+}
+
+/*
+ * @brief Handler function for sensorcal command
+ *
+ * <sensorcal> or <sensorcal hw> starts the six position calibration, which completes on
+ * the sixth switch press. hw moves the offsets in to the accelerometer. <sensorcal show>
+ * prints the calibration in use and <sensorcal clear> removes it
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_sensorcal(int argc, char *argv[])
+{
+	mma_calibration_t calibration;
+
+	if((argc == 2) && (strcasecmp(argv[1], "show") == 0))
+	{
+		mma_get_calibration(&calibration);
+		sensorcal_print(&calibration);
+		return;
+	}
+	if((argc > 2) || ((argc == 2) && (strcasecmp(argv[1], "hw") != 0) && (strcasecmp(argv[1], "clear") != 0)))
+	{
+		printf("Wrong Syntax! Refer Help for sensorcal syntax\n\r");
+		return;
+	}
+	if(reject_if_busy())
+	{
+		return;
+	}
+	if((argc == 2) && (strcasecmp(argv[1], "clear") == 0))
+	{
+		mma_set_calibration(NULL);
+		mma_get_calibration(&calibration);
+		printf(sensor_calibration_save(&calibration) ? "Sensor calibration cleared\n\r" :
+				"Sensor calibration cleared, but it could not be stored\n\r");
+		return;
+	}
+	sensorcal_hw = (argc == 2);
+	sensorcal_done = 0;
+	mma_get_calibration(&sensorcal_previous);
+	mma_set_calibration(NULL);							/*Capture the uncorrected output*/
+	reset_switch();
+	sensorcal_print_remaining();
+	start_job(&sensorcal_job);
+}
+
+/*
+ * @brief Handler function for blog command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_blog(int argc, char *argv[])
+{
+	if(argc == 1)
+	{
+		blog_report();
+	}
+	else if((argc == 2) && (strcasecmp(argv[1], "dump") == 0))
+	{
+		blog_dump();
+	}
+	else
+	{
+		printf("Wrong Syntax! Refer Help for blog syntax\n\r");
+	}
+}
+
+/*
+ * @brief Handler function for set angle command
+ *
+ * Validates the angle and starts the measurement, which is stepped on every sample event
+ * until the angle is reached or the command is cancelled
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_set_angle(int argc, char *argv[])
+{
+	int input_angle=0;								/*The angle given by user*/
+	if(argc!=2)
+	{
+		printf("Wrong Syntax! Refer Help for set(angle) syntax\n\r");
+		return;
+	}
+	if (reject_if_busy())
+	{
+		return;
+	}
+	for(int i=0;argv[1][i]!='\0';i++)
+	{
+		if((argv[1][i] > '9') || (argv[1][i] < '0'))		/*Checking whether alphabets present in length without 0x*/
+		{
+			printf("Enter Valid Angle from 0 - 180\n\r");
+			return;
+		}
+	}
+	input_angle =  strtol(argv[1],NULL, 10);							/*Converting the address to decimal representation*/
+	if ((input_angle < MINIMUM_ANGLE) || (input_angle > MAXIMUM_ANGLE))
+	{
+		printf("Enter Valid angle from 0 - 180\n\r");
+		return;
+	}
+	else if(maximum_angle < input_angle)
+	{
+		printf("The maximum angle that can be measured is %d\n\r", maximum_angle);
+		return;
+
+	}
+	else
+	{
+		printf("Input angle given as %d, Move the accelerometer to the desired angle\n\r", input_angle);
+	}
+	update_led_colour(OFF, OFF, GREEN);
+	set_input_angle = input_angle;
+	set_measure_angle = NO_ANGLE;
+	set_last_angle = NO_ANGLE;
+	start_job(&set_angle_job);
+}
+
+/*
+ * @brief Handler function for events command
  *
  * @param1 argc number of tokens
  * @param2 argv Every index consists a token
  * @return void
  */
-void handle_help(int argc, char *argv[])
+void handle_events(int argc, char *argv[])
 {
 	if(argc!=1)
 	{
-		printf("Wrong Syntax! Refer Help for Help syntax\n\r"); /*Checking the number of tokens*/
+		printf("Wrong Syntax! Refer Help for events syntax\n\r");
 		return;
 	}
-	for(int i=0;i<num_commands;i++)
+	events_report();
+	deferred_report();
+}
+
+/*
+ * @brief Handler function for boot command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_boot(int argc, char *argv[])
+{
+	boot_mode_t mode;
+	if(argc == 1)
 	{
-		printf(commands[i].help_string);
+		selftest_report();
+		return;
+	}
+	if((argc != 2) || !selftest_boot_mode_from_name(argv[1], &mode))
+	{
+		printf("Wrong Syntax! Refer Help for boot syntax\n\r");
+		return;
+	}
+	if(selftest_set_boot_mode(mode))
+	{
+		printf("Boot mode %s is used from the next power-up\n\r", argv[1]);
+	}
+	else
+	{
+		printf("Boot mode could not be stored in flash\n\r");
 	}
-
 }
 
 /*
- * @brief Handler function for calibrate command
+ * @brief Handler function for test command
+ *
+ * Runs the full self-test suite, the console is blocked until it completes
  *
  * @param1 argc number of tokens
  * @param2 argv Every index consists a token
  * @return void
  */
-void handle_calibrate(int argc, char *argv[])
+void handle_test(int argc, char *argv[])
 {
 	if(argc!=1)
 	{
-		printf("Wrong Syntax! Refer Help for calibrate syntax\n\r");
+		printf("Wrong Syntax! Refer Help for test syntax\n\r");
 		return;
 	}
-	update_led_colour(RED, OFF, OFF);
-	printf("Move the board to reference zero and press switch to set the position\n\r");
-	reset_switch();
-	while(! check_switch_pressed());
-	reference = abs(get_roll());
-	if (reference < DEGREE_90)										/*Checking whether reference is above or below 90*/
+	if (reject_if_busy())
 	{
-		maximum_angle =  MAXIMUM_ANGLE - reference;					/*maximum angle that can be measured post zero reference*/
-		printf("\n\rSwitch is pressed, Reference zero angle is set as %d, Use this to measure the angle you require\n\r", reference);
-		printf("\n\rWith this zero reference , you can measure up to %d\n\r",maximum_angle);
-		update_led_colour(OFF, GREEN, OFF);
+		return;
 	}
-	else if (reference > DEGREE_90)
+	selftest_run(BOOT_FULL);
+}
+
+/*
+ * @brief Handler function for timeline command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_timeline(int argc, char *argv[])
+{
+	if(argc!=1)
 	{
-		printf("The reference zero can only be set between 0 to 90, type calibrate to again set zero reference\n\r");
+		printf("Wrong Syntax! Refer Help for timeline syntax\n\r");
 		return;
 	}
-
+	boottime_report();
 }
 
 /*
- * @brief Handler function for set angle command
+ * @brief Handler function for cancel command
  *
  * @param1 argc number of tokens
  * @param2 argv Every index consists a token
  * @return void
  */
-void handle_set_angle(int argc, char *argv[])
+void handle_cancel(int argc, char *argv[])
 {
-	int input_angle=0;								/*The angle given by user*/
-	int measure_angle=0;
-	int angle_zero=0;
-	float intensity_red=0;							/*To store the intensity of Red , Blue, Green to be loaded in TPM registers*/
-	float intensity_green=0;
-	float intensity_blue =0;
-	if(argc!=2)
+	if(argc!=1)
 	{
-		printf("Wrong Syntax! Refer Help for set(angle) syntax\n\r");
+		printf("Wrong Syntax! Refer Help for cancel syntax\n\r");
 		return;
 	}
-	for(int i=0;argv[1][i]!='\0';i++)
+	if (active_job == NULL)
 	{
-		if((argv[1][i] > '9') || (argv[1][i] < '0'))		/*Checking whether alphabets present in length without 0x*/
-		{
-			printf("Enter Valid Angle from 0 - 180\n\r");
-			return;
-		}
+		printf("No command in progress\n\r");
+		return;
 	}
-	input_angle =  strtol(argv[1],NULL, 10);							/*Converting the address to decimal representation*/
-	if ((input_angle < MINIMUM_ANGLE) || (input_angle > MAXIMUM_ANGLE))
+	active_job->cancel();
+	end_job();
+}
+
+/*
+ * @brief Handler function for store command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_store(int argc, char *argv[])
+{
+	if(argc!=1)
 	{
-		printf("Enter Valid angle from 0 - 180\n\r");
+		printf("Wrong Syntax! Refer Help for store syntax\n\r");
 		return;
 	}
-	else if(maximum_angle < input_angle)
+	settings_report();
+}
+
+/*
+ * @brief Handler function for trace command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_trace(int argc, char *argv[])
+{
+	static const command_job_t *const jobs[] = {&calibrate_job, &set_angle_job, &log_job, &sensorcal_job};
+
+	if(argc == 1)
 	{
-		printf("The maximum angle that can be measured is %d\n\r", maximum_angle);
+		trace_report();
 		return;
-
 	}
-	else
+	if((argc == 2) && (strcasecmp(argv[1], "start") == 0))
 	{
-		printf("Input angle given as %d, Move the accelerometer to the desired angle\n\r", input_angle);
+		trace_start();
+		printf("Tracing, type trace stop or trace dump to end\n\r");
 	}
-	update_led_colour(OFF, OFF, GREEN);
-	while (measure_angle != input_angle)
+	else if((argc == 2) && (strcasecmp(argv[1], "stop") == 0))
 	{
-		angle_zero = abs(get_roll());
-		measure_angle = abs(get_roll()) - reference ;
-		if (measure_angle == input_angle)
-		{
-			update_led_colour(RED, OFF, OFF);
-		}
-		else if((angle_zero <= reference) && (reference !=0))				/*When angle is far away from the destination angle*/
+		trace_stop();
+		trace_report();
+	}
+	else if((argc == 2) && (strcasecmp(argv[1], "dump") == 0))
+	{
+		trace_dump();
+	}
+	else if((argc == 3) && (strcasecmp(argv[1], "size") == 0))
+	{
+		if (!trace_set_window((uint32_t)atoi(argv[2])))
 		{
-			intensity_green = (((float)angle_zero / (float) reference) * MAX_INTENSITY); /*Green value decrease when angle is far away*/
-			intensity_blue = (((float)(reference - angle_zero) / (float) reference ) * MAX_INTENSITY);
-			update_led_colour(OFF, intensity_green, intensity_blue);
+			printf("The size must be a power of 2 from %d to %d bytes\n\r", TRACE_MIN_WINDOW, __MTB_BUFFER_SIZE);
 		}
-		else if((measure_angle <= reference) || (reference == 0))		/*When angle is close to the destination angle*/
+	}
+	else if((argc == 3) && (strcasecmp(argv[1], "step") == 0))
+	{
+		for (unsigned int job = 0; job < sizeof(jobs) / sizeof(jobs[0]); job++)
 		{
-			intensity_red = (((float)measure_angle / (float)input_angle) * MAX_INTENSITY); /*Red value increases when angle is closer*/
-			intensity_green = (((float)(input_angle - measure_angle) / (float)input_angle ) * MAX_INTENSITY);
-			update_led_colour(intensity_red, intensity_green, OFF);
+			if (strcasecmp(argv[2], jobs[job]->name) == 0)
+			{
+				trace_arm(jobs[job]->name);
+				printf("The next %s step will be traced\n\r", jobs[job]->name);
+				return;
+			}
 		}
+		printf("Enter calibrate, set, log or sensorcal\n\r");
+	}
+	else
+	{
+		printf("Wrong Syntax! Refer Help for trace syntax\n\r");
+	}
+}
 
+/*
+ * @brief Handler function for mem command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_mem(int argc, char *argv[])
+{
+	if(argc!=1)
+	{
+		printf("Wrong Syntax! Refer Help for mem syntax\n\r");
+		return;
+	}
+	mem_report();
+}
+
+/*
+ * @brief Handler function for crit command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_crit(int argc, char *argv[])
+{
+	if(argc!=1)
+	{
+		printf("Wrong Syntax! Refer Help for crit syntax\n\r");
+		return;
 	}
-	printf("Desired angle is reached\n\r");
-	reference = 0;
-	printf("Type calibrate if you want to set reference position before measuring another angle\n\r");
-	printf("Current Reference Angle = %d\n\r",reference);
+	crit_report();
+}
 
+/*
+ * @brief Handler function for irq command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_irq(int argc, char *argv[])
+{
+	if(argc!=1)
+	{
+		printf("Wrong Syntax! Refer Help for irq syntax\n\r");
+		return;
+	}
+	irqstat_report();
+}
 
+/*
+ * @brief Handler function for status command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_status(int argc, char *argv[])
+{
+	if(argc!=1)
+	{
+		printf("Wrong Syntax! Refer Help for status syntax\n\r");
+		return;
+	}
+	if (active_job == NULL)
+	{
+		printf("No command in progress\n\r");
+		return;
+	}
+	active_job->status();
 }
 
 /*
@@ -217,11 +1069,86 @@ void handle_info(int argc, char *argv[])
 		printf("Wrong Syntax! Refer Help for info syntax\n\r");
 		return;
 	}
-	printf("Current Roll Angle: %d\n\r",abs(get_roll()));
+	fmt_printf("Current Roll Angle: %d\n\r",abs(get_roll()));
+	const sysclock_profile_t *clock = sysclock_profile();
+	printf("Clock profile: %s -- Core %lu Hz, Bus %lu Hz, Peripheral %lu Hz\n\r", clock->name,
+			(unsigned long)clock->core_hz, (unsigned long)clock->bus_hz, (unsigned long)clock->peripheral_hz);
 	//printf("Version Tag:%s -- Build Machine:%s -- Build Date: %s\n\r",VERSION_TAG, VERSION_BUILD_MACHINE,VERSION_BUILD_DATE);
 }
 
 
+/*
+ * @brief Handler function for cpu command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_cpu(int argc, char *argv[])
+{
+	if(argc!=1)
+	{
+		printf("Wrong Syntax! Refer Help for cpu syntax\n\r");
+		return;
+	}
+	cpu_load_report();
+}
+
+
+/*
+ * @brief Handler function for lat command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_latency(int argc, char *argv[])
+{
+	if(argc!=1)
+	{
+		printf("Wrong Syntax! Refer Help for lat syntax\n\r");
+		return;
+	}
+	latency_report();
+}
+
+
+/*
+ * @brief Handler function for prof command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_prof(int argc, char *argv[])
+{
+	if(argc!=1)
+	{
+		printf("Wrong Syntax! Refer Help for prof syntax\n\r");
+		return;
+	}
+	profiler_report();
+}
+
+
+/*
+ * @brief Handler function for timers command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_timers(int argc, char *argv[])
+{
+	if(argc!=1)
+	{
+		printf("Wrong Syntax! Refer Help for timers syntax\n\r");
+		return;
+	}
+	swtimer_report();
+}
+
+
 /*
  * @brief Parses the input string in to tokens and calls the handler function
  *
@@ -280,46 +1207,118 @@ void process_command(char *input)
 /*
  * @brief To accumulate the input buffer and handles user backspace
  *
- * @return void
+ * Consumes the characters received so far without waiting for more, a complete line
+ * is processed as a command
+ *
+ * @return true if at least one character was consumed
  */
-void accumulator()
+bool accumulator()
 {
-
-    int count=0;										/*Variable used for backspace functionality*/
-	while(1)
+	bool consumed = false;
+	int input;
+	while((input = uart0_try_getchar()) >= 0)			/*Getting input from the user*/
 	{
-	buffer1[i] = getchar();								/*Getting input from the user*/
-	if (buffer1[i] == '\b')
+	consumed = true;
+	if (input == '\0')
 	{
-		if(count > 0)
-		{
-		printf("%c",buffer1[i]);						/*Echoing the character to the user*/
-		count--;
-		printf(" \b \b");
-		i=i-2;										/*Decrementing by 2 to include backspace and the character removed*/
-		}
+		continue;
 	}
-	else
+	if (input == '\b')
 	{
-		printf("%c",buffer1[i]);
-		count++;
+		if(i > 0)										/*Nothing to erase at the start of the line*/
+		{
+		fmt_char(input);							/*Echoing the character to the user*/
+		fmt_str(" \b \b");
+		i--;
+		}
+		continue;
 	}
 
-	if(buffer1[i] == '\r')					    	/*Check when the entire command is complete*/
+	if(input == '\r')					    		/*Check when the entire command is complete*/
 	{
+	fmt_char(input);
 	printf("\n\r");
 	buffer1[i]='\0';
+	PROF_BEGIN(PROF_PROCESS_COMMAND);
+	cpu_task_t previous = cpu_task_enter(CPU_TASK_COMMAND);
 	process_command(buffer1);
+	cpu_task_exit(previous);
+	PROF_END(PROF_PROCESS_COMMAND);
 	i=0;
-	break;
+	prompt_if_free();
+	continue;
 	}
-	else
+
+	if(i >= (int)(sizeof(buffer1) - 1))				/*Line full, keep room for the terminating character*/
 	{
-		i++;
+		continue;									/*Dropped without echo until the line ends*/
 	}
+	PROF_BEGIN(PROF_ECHO);
+	fmt_char(input);
+	PROF_END(PROF_ECHO);
+	buffer1[i++] = input;
 	}
-
+	return consumed;
 }
 
+/*
+ * @brief Console input event handler, echoes and processes the received characters
+ *
+ * @param event EVENT_UART_RX
+ * @return void
+ */
+static void console_event(event_t event)
+{
+	accumulator();
+}
 
+/*
+ * @brief Wake event handler of the long-running commands, runs one step of the command
+ * in progress if it waits for this event
+ *
+ * @param event the event dispatched
+ * @return void
+ */
+static void job_event(event_t event)
+{
+	if ((active_job == NULL) || (active_job->wake != event))
+	{
+		return;
+	}
+	cpu_task_t previous = cpu_task_enter(CPU_TASK_COMMAND);
+	trace_begin(active_job->name);				/*Does nothing unless a trace step command armed it*/
+	job_status_t status = active_job->step();
+	trace_end(active_job->name);
+	cpu_task_exit(previous);
+	if (status == JOB_DONE)
+	{
+		end_job();
+		prompt_if_free();
+	}
+}
 
+/*
+ * @brief Restores the stored reference, registers the console and command event handlers
+ * and prints the first prompt
+ *
+ * @return void
+ */
+void command_init(void)
+{
+	calibration_t calibration;
+	mma_calibration_t sensor_calibration;
+	if (sensor_calibration_load(&sensor_calibration))
+	{
+		mma_set_calibration(&sensor_calibration);
+	}
+	if (calibration_load(&calibration))
+	{
+		reference = calibration.reference;
+		maximum_angle = calibration.maximum_angle;
+		printf("Stored reference zero %d, you can measure up to %d\n\r", reference, maximum_angle);
+	}
+	event_register(EVENT_UART_RX, console_event);
+	event_register(EVENT_SWITCH, job_event);
+	event_register(EVENT_SAMPLE, job_event);
+	prompt_if_free();
+}
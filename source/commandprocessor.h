@@ -13,9 +13,49 @@
 #ifndef COMMANDPROCESSOR_H_
 #define COMMANDPROCESSOR_H_
 
+#include <stdbool.h>
 
+#define INPUT_BUFFER_SIZE 200			/*Longest command line, including the terminating character*/
 
 
+
+
+/*
+ * @brief Handler function for ram command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_ram(int argc, char *argv[]);
+
+/*
+ * @brief Handler function for log command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_log(int argc, char *argv[]);
+
+/*
+ * @brief Handler function for sensorcal command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_sensorcal(int argc, char *argv[]);
+
+/*
+ * @brief Handler function for blog command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_blog(int argc, char *argv[]);
+
 /*
  * @brief Handler function for set angle command
  *
@@ -35,9 +75,129 @@ void handle_calibrate(int argc, char *argv[]);
 /*
  * @brief To accumulate the input buffer and handles user backspace
  *
+ * Consumes the characters received so far without waiting for more, a complete line
+ * is processed as a command
+ *
+ * @return true if at least one character was consumed
+ */
+bool accumulator();
+
+/*
+ * @brief Restores the stored reference, registers the console and command event handlers
+ * and prints the first prompt
+ *
+ * calibrate, set, log and sensorcal run as state machines stepped by the switch and sample
+ * events, so the console stays responsive to cancel and status while they are in progress
+ *
+ * @return void
+ */
+void command_init(void);
+
+/*
+ * @brief To check whether a long-running command is in progress
+ *
+ * @return true if a calibrate, set, log or sensorcal command is in progress
+ */
+bool command_busy(void);
+
+/*
+ * @brief Handler function for timeline command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_timeline(int argc, char *argv[]);
+
+/*
+ * @brief Handler function for cancel command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_cancel(int argc, char *argv[]);
+
+/*
+ * @brief Handler function for events command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_events(int argc, char *argv[]);
+
+/*
+ * @brief Handler function for boot command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_boot(int argc, char *argv[]);
+
+/*
+ * @brief Handler function for test command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
  * @return void
  */
-void accumulator();
+void handle_test(int argc, char *argv[]);
+
+/*
+ * @brief Handler function for store command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_store(int argc, char *argv[]);
+
+/*
+ * @brief Handler function for trace command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_trace(int argc, char *argv[]);
+
+/*
+ * @brief Handler function for mem command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_mem(int argc, char *argv[]);
+
+/*
+ * @brief Handler function for crit command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_crit(int argc, char *argv[]);
+
+/*
+ * @brief Handler function for irq command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_irq(int argc, char *argv[]);
+
+/*
+ * @brief Handler function for status command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_status(int argc, char *argv[]);
 
 /*
  * @brief Parses the input string in to tokens and calls the handler function
@@ -78,5 +238,45 @@ void handle_info(int argc, char *argv[]);
 void handle_help(int argc, char *argv[]);
 
 
+/*
+ * @brief Handler function for cpu command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_cpu(int argc, char *argv[]);
+
+
+/*
+ * @brief Handler function for lat command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_latency(int argc, char *argv[]);
+
+
+/*
+ * @brief Handler function for prof command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_prof(int argc, char *argv[]);
+
+
+/*
+ * @brief Handler function for timers command
+ *
+ * @param1 argc number of tokens
+ * @param2 argv Every index consists a token
+ * @return void
+ */
+void handle_timers(int argc, char *argv[]);
+
+
 #endif /* COMMANDPROCESSOR_H_ */
 
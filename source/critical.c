@@ -0,0 +1,189 @@
+/**
+ * @file    critical.c
+ * @brief   This source file consists of function definitions of the nested critical sections,
+ * 			which mask interrupts and record how long they stayed masked at every call site
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "critical.h"
+#include "sysclock.h"
+
+#define CRIT_TIMER_CHANNEL 0
+
+#if CRITICAL_STATS_ENABLE
+
+typedef struct
+{
+	uint32_t count;
+	uint32_t max;
+	uint64_t total;
+	uint32_t over_budget;
+	uint32_t histogram[CRIT_HISTOGRAM_BUCKETS];
+} crit_entry_t;
+
+static const char *site_names[CRIT_NUM_SITES] = {"timebase", "event post", "event take", "deferred",
+												 "switch", "led fade", "cpu load", "blog", "flash",
+												 "ram bench", "latency"};
+
+static crit_entry_t crit_table[CRIT_NUM_SITES];
+static bool timing = false;						/*Set once the PIT runs, its registers fault before*/
+static uint32_t budget_cycles = 0;
+static uint32_t outer_start;					/*PIT count when the outermost section was entered*/
+
+
+/*
+ * @brief Bus cycles counted down by the free running PIT channel
+ *
+ * @return current count
+ */
+static inline uint32_t crit_now(void)
+{
+	return PIT->CHANNEL[CRIT_TIMER_CHANNEL].CVAL;
+}
+
+/*
+ * @brief Masks the interrupts, starts timing if this is the outermost section
+ *
+ * @param site call site the section is charged to
+ * @return state to pass to crit_exit()
+ */
+crit_state_t crit_enter(crit_site_t site)
+{
+	crit_state_t state = __get_PRIMASK();
+	__disable_irq();
+	if ((state == 0) && timing)
+	{
+		outer_start = crit_now();
+	}
+	return state;
+}
+
+/*
+ * @brief Restores the interrupt mask, records the masked time if this is the outermost section
+ *
+ * @param1 site call site given to crit_enter()
+ * @param2 state returned by crit_enter()
+ * @return void
+ */
+void crit_exit(crit_site_t site, crit_state_t state)
+{
+	if ((state == 0) && timing)
+	{
+		uint32_t cycles = outer_start - crit_now();		/*The PIT counts down*/
+		crit_entry_t *entry = &crit_table[site];
+		int bucket = (cycles != 0) ? (31 - __builtin_clz(cycles)) : 0;
+
+		if (bucket >= CRIT_HISTOGRAM_BUCKETS)
+		{
+			bucket = CRIT_HISTOGRAM_BUCKETS - 1;
+		}
+		entry->histogram[bucket]++;
+		entry->count++;
+		entry->total += cycles;
+		if (cycles > entry->max)
+		{
+			entry->max = cycles;
+		}
+		if (cycles > budget_cycles)
+		{
+			entry->over_budget++;
+		}
+	}
+	__set_PRIMASK(state);
+}
+
+/*
+ * @brief Starts the PIT which times the critical sections, sections entered before are not timed
+ *
+ * @return void
+ */
+void crit_init(void)
+{
+	SIM->SCGC6 |= SIM_SCGC6_PIT_MASK;
+	PIT->MCR = 0;								/*Module enabled, keeps running in debug halt*/
+	PIT->CHANNEL[CRIT_TIMER_CHANNEL].LDVAL = 0xFFFFFFFF;
+	PIT->CHANNEL[CRIT_TIMER_CHANNEL].TCTRL = PIT_TCTRL_TEN_MASK;	/*No interrupt, wraps after ~179 s at 24 MHz*/
+	budget_cycles = (uint32_t)(((uint64_t)sysclock_profile()->bus_hz * CRIT_BUDGET_US) / 1000000U);
+	timing = true;
+}
+
+/*
+ * @brief Converts PIT counts in to microseconds with the exact bus clock
+ *
+ * @param1 cycles bus clock cycles
+ * @param2 bus_hz bus clock of the profile
+ * @return microseconds
+ */
+static uint32_t bus_cycles_to_us(uint64_t cycles, uint32_t bus_hz)
+{
+	return (uint32_t)((cycles * 1000000U) / bus_hz);
+}
+
+/*
+ * @brief Prints per call site the number of sections, the worst and mean masked time and
+ * a histogram, flags the sites over CRIT_BUDGET_US and clears the statistics
+ *
+ * @return void
+ */
+void crit_report(void)
+{
+	crit_entry_t snapshot[CRIT_NUM_SITES];
+	uint32_t bus_hz = sysclock_profile()->bus_hz;
+
+	crit_state_t state = __get_PRIMASK();		/*Not a timed site, the copy is not part of any budget*/
+	__disable_irq();
+	memcpy(snapshot, crit_table, sizeof(crit_table));
+	memset(crit_table, 0, sizeof(crit_table));
+	__set_PRIMASK(state);
+
+	printf("Site\t\tCount\tMax(us)\tMean(us)\tOver %dus\n\r", CRIT_BUDGET_US);
+	for (int site = 0; site < CRIT_NUM_SITES; site++)
+	{
+		crit_entry_t *entry = &snapshot[site];
+		if (entry->count == 0)
+		{
+			continue;
+		}
+		printf("%-10s\t%lu\t%lu\t%lu\t\t%lu%s\n\r", site_names[site], (unsigned long)entry->count,
+				(unsigned long)bus_cycles_to_us(entry->max, bus_hz),
+				(unsigned long)bus_cycles_to_us(entry->total / entry->count, bus_hz),
+				(unsigned long)entry->over_budget, (entry->over_budget != 0) ? "  OVER BUDGET" : "");
+		printf("  log2 histogram (bus cycles at %lu Hz):", (unsigned long)bus_hz);
+		for (int bucket = 0; bucket < CRIT_HISTOGRAM_BUCKETS; bucket++)
+		{
+			if (entry->histogram[bucket] != 0)
+			{
+				printf(" [%lu+]=%lu", 1UL << bucket, (unsigned long)entry->histogram[bucket]);
+			}
+		}
+		printf("\n\r");
+	}
+}
+
+#else
+
+/*
+ * @brief Starts the PIT which times the critical sections
+ *
+ * @return void
+ */
+void crit_init(void)
+{
+}
+
+/*
+ * @brief Prints the critical section statistics
+ *
+ * @return void
+ */
+void crit_report(void)
+{
+	printf("Critical section statistics are not enabled in this build\n\r");
+}
+
+#endif
@@ -0,0 +1,107 @@
+/**
+ * @file    critical.h
+ * @brief   This header file consists of the nested critical section functions, which mask
+ * 			interrupts and record how long they stayed masked at every call site
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * crit_enter() saves PRIMASK and masks the interrupts, crit_exit() restores the saved state,
+ * so critical sections nest. Only the outermost section of a nest is timed, as that is the
+ * time an interrupt waits; it is charged to the site which opened it. The sections are
+ * timed with PIT channel 0 running free on the bus clock, so windows much longer than the
+ * 1 ms systick period, such as flash erases, are measured correctly.
+ *
+ * The statistics are kept in Debug builds, define CRITICAL_STATS_ENABLE as 0 or 1 to
+ * override; without them crit_enter() and crit_exit() are just the PRIMASK save and restore.
+ * The masked sleeps of idle_wait() and events_run() are not critical sections: the
+ * interrupt which wakes the core runs as soon as it is unmasked.
+ */
+
+#ifndef CRITICAL_H_
+#define CRITICAL_H_
+
+#include <stdint.h>
+#include "MKL25Z4.h"
+
+#if !defined(CRITICAL_STATS_ENABLE)
+#if defined(DEBUG)
+#define CRITICAL_STATS_ENABLE 1
+#else
+#define CRITICAL_STATS_ENABLE 0
+#endif
+#endif
+
+#define CRIT_HISTOGRAM_BUCKETS 16	/*Bucket n counts sections of 2^n to 2^(n+1)-1 bus cycles, the last one everything above*/
+#define CRIT_BUDGET_US 100			/*Worst masked time allowed, about a third of a character at 38400 baud*/
+
+typedef enum
+{
+	CRIT_TIMEBASE = 0,
+	CRIT_EVENT_POST,
+	CRIT_EVENT_TAKE,
+	CRIT_DEFERRED,
+	CRIT_SWITCH,
+	CRIT_LED_FADE,
+	CRIT_CPU_LOAD,
+	CRIT_BLOG,
+	CRIT_FLASH,
+	CRIT_RAM_BENCH,
+	CRIT_LATENCY,
+	CRIT_NUM_SITES
+} crit_site_t;
+
+typedef uint32_t crit_state_t;		/*PRIMASK before the section*/
+
+#if CRITICAL_STATS_ENABLE
+
+/*
+ * @brief Masks the interrupts, starts timing if this is the outermost section
+ *
+ * @param site call site the section is charged to
+ * @return state to pass to crit_exit()
+ */
+crit_state_t crit_enter(crit_site_t site);
+
+/*
+ * @brief Restores the interrupt mask, records the masked time if this is the outermost section
+ *
+ * @param1 site call site given to crit_enter()
+ * @param2 state returned by crit_enter()
+ * @return void
+ */
+void crit_exit(crit_site_t site, crit_state_t state);
+
+#else
+
+static inline crit_state_t crit_enter(crit_site_t site)
+{
+	crit_state_t state = __get_PRIMASK();
+	__disable_irq();
+	return state;
+}
+
+static inline void crit_exit(crit_site_t site, crit_state_t state)
+{
+	__set_PRIMASK(state);
+}
+
+#endif
+
+/*
+ * @brief Starts the PIT which times the critical sections, sections entered before are not timed
+ *
+ * @return void
+ */
+void crit_init(void);
+
+/*
+ * @brief Prints per call site the number of sections, the worst and mean masked time and
+ * a histogram, flags the sites over CRIT_BUDGET_US and clears the statistics
+ *
+ * @return void
+ */
+void crit_report(void);
+
+
+#endif /* CRITICAL_H_ */
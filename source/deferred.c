@@ -0,0 +1,116 @@
+/**
+ * @file    deferred.c
+ * @brief   This source file consists of function definitions of the deferred interrupt work
+ * 			queue, run as bottom halves from the PendSV exception
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ */
+
+#include <stdio.h>
+#include "deferred.h"
+#include "timer.h"
+#include "blog.h"
+#include "critical.h"
+#include "irqstat.h"
+#include "MKL25Z4.h"
+
+#define QUEUE_MASK (DEFERRED_QUEUE_SIZE - 1)
+
+typedef struct
+{
+	deferred_fn_t fn;
+	void *arg;
+} deferred_work_t;
+
+static deferred_work_t queue[DEFERRED_QUEUE_SIZE];
+static volatile uint32_t head = 0;				/*Next item to run, only advanced by PendSV*/
+static volatile uint32_t tail = 0;				/*Next free slot, advanced with interrupts masked*/
+static volatile uint32_t runs = 0;
+static volatile uint32_t drops = 0;				/*Posts lost because the queue was full*/
+static volatile uint32_t max_depth = 0;
+static volatile uint32_t max_run_cycles = 0;	/*Longest single bottom half*/
+
+
+/*
+ * @brief Sets the PendSV priority, to be called before any interrupt is enabled
+ *
+ * @return void
+ */
+void deferred_init(void)
+{
+	NVIC_SetPriority(PendSV_IRQn, DEFERRED_IRQ_PRIORITY);
+}
+
+/*
+ * @brief Queues a bottom half and pends PendSV, safe to call from interrupt handlers
+ *
+ * @param1 fn function to run from PendSV
+ * @param2 arg argument passed to fn
+ * @return true if queued, false if the queue was full and the work was dropped
+ */
+bool deferred_post(deferred_fn_t fn, void *arg)
+{
+	bool queued = false;
+	crit_state_t masking_state = crit_enter(CRIT_DEFERRED);	/*Top halves of different priorities may post*/
+	uint32_t depth = tail - head;
+	if (depth < DEFERRED_QUEUE_SIZE)
+	{
+		queue[tail & QUEUE_MASK].fn = fn;
+		queue[tail & QUEUE_MASK].arg = arg;
+		tail++;
+		if (depth + 1 > max_depth)
+		{
+			max_depth = depth + 1;
+		}
+		queued = true;
+	}
+	else
+	{
+		drops++;
+		BLOG2("deferred: queue full, dropped %x(%x)", fn, arg);
+	}
+	crit_exit(CRIT_DEFERRED, masking_state);
+	SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+	return queued;
+}
+
+/*
+ * @brief PendSV exception, runs the queued bottom halves in posting order
+ *
+ * Interrupts stay enabled while a bottom half runs. An item is only freed after it has
+ * run, so a full queue drops new work rather than overwriting work not yet done
+ *
+ * @return void
+ */
+void PendSV_Handler(void)
+{
+	IRQ_STAT_ENTER(IRQ_LATENCY_UNKNOWN);
+	while (head != tail)
+	{
+		deferred_work_t work = queue[head & QUEUE_MASK];
+		uint32_t start = timebase_cycles();
+		work.fn(work.arg);
+		uint32_t run = timebase_cycles() - start;
+		if (run > max_run_cycles)
+		{
+			max_run_cycles = run;
+		}
+		runs++;
+		head++;
+	}
+	IRQ_STAT_EXIT(IRQ_STAT_PENDSV);
+}
+
+/*
+ * @brief Prints the number of work items run and dropped, the deepest the queue has been
+ * and the longest bottom half
+ *
+ * @return void
+ */
+void deferred_report(void)
+{
+	printf("Bottom halves run %lu, dropped %lu, queue peak %lu of %d, longest %lu us\n\r",
+			(unsigned long)runs, (unsigned long)drops, (unsigned long)max_depth, DEFERRED_QUEUE_SIZE,
+			(unsigned long)timebase_cycles_to_us(max_run_cycles));
+}
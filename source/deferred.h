@@ -0,0 +1,56 @@
+/**
+ * @file    deferred.h
+ * @brief   This header file consists of function prototypes of the deferred interrupt work
+ * 			queue, run as bottom halves from the PendSV exception
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * An interrupt handler (top half) only latches its data, clears the interrupt and posts
+ * the rest of its work here. PendSV runs at the lowest NVIC priority, so the bottom
+ * halves run in posting order once no other handler is active. Every top half must be
+ * set strictly above DEFERRED_IRQ_PRIORITY: UART0 runs at 1, SysTick, TPM2 and PORTD at 2.
+ * A long bottom half then never delays the top half of another interrupt; at equal
+ * priority a pending PendSV would even be taken before a pending SysTick, as the lower
+ * exception number wins the tie. Bottom halves still preempt the main loop.
+ */
+
+#ifndef DEFERRED_H_
+#define DEFERRED_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define DEFERRED_QUEUE_SIZE 8			/*Work items waiting at the same time, power of 2*/
+#define DEFERRED_IRQ_PRIORITY 3			/*Lowest priority of the KL25Z NVIC, no top half may use it*/
+
+typedef void (*deferred_fn_t)(void *arg);
+
+
+/*
+ * @brief Sets the PendSV priority, to be called before any interrupt is enabled
+ *
+ * @return void
+ */
+void deferred_init(void);
+
+/*
+ * @brief Queues a bottom half and pends PendSV, safe to call from interrupt handlers
+ *
+ * @param1 fn function to run from PendSV
+ * @param2 arg argument passed to fn
+ * @return true if queued, false if the queue was full and the work was dropped
+ */
+bool deferred_post(deferred_fn_t fn, void *arg);
+
+/*
+ * @brief Prints the number of work items run and dropped, the deepest the queue has been
+ * and the longest bottom half
+ *
+ * @return void
+ */
+void deferred_report(void);
+
+
+#endif /* DEFERRED_H_ */
@@ -0,0 +1,154 @@
+/**
+ * @file    events.c
+ * @brief   This source file consists of function definitions of the event queue which drives
+ * 			the run-to-completion main loop
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * The queue is a bitmask of pending events, so posting never fails and never allocates.
+ * The bitmask and the post timestamps are shared with interrupt handlers and are only
+ * accessed with interrupts masked.
+ */
+
+#include <stdio.h>
+#include "events.h"
+#include "timer.h"
+#include "idle.h"
+#include "critical.h"
+#include "MKL25Z4.h"
+
+#define EVENT_BIT(event) (1UL << (event))
+
+static const char *event_names[EVENT_COUNT] = {"timer", "switch", "sample", "uart rx"};
+
+static event_handler_t handlers[EVENT_COUNT];
+static volatile uint32_t pending_events = 0;				/*Bit per pending event*/
+static volatile uint32_t posted_at[EVENT_COUNT];			/*Timebase cycles of the first post while pending*/
+static volatile uint32_t posts[EVENT_COUNT];
+static volatile uint32_t merged[EVENT_COUNT];				/*Posts made while the event was already pending*/
+static uint32_t dispatches[EVENT_COUNT];
+static uint32_t max_latency_cycles[EVENT_COUNT];			/*Worst time from post to the handler starting*/
+static uint32_t max_run_cycles[EVENT_COUNT];				/*Worst handler run time*/
+
+
+/*
+ * @brief Registers the handler run when an event is dispatched, replacing any previous one
+ *
+ * @param1 event event to handle
+ * @param2 handler function run from the main loop, NULL to ignore the event
+ * @return void
+ */
+void event_register(event_t event, event_handler_t handler)
+{
+	handlers[event] = handler;
+}
+
+/*
+ * @brief Marks an event as pending, safe to call from interrupt handlers
+ *
+ * @param event event to post
+ * @return void
+ */
+void event_post(event_t event)
+{
+	crit_state_t masking_state = crit_enter(CRIT_EVENT_POST);
+	posts[event]++;
+	if (pending_events & EVENT_BIT(event))
+	{
+		merged[event]++;
+	}
+	else
+	{
+		pending_events |= EVENT_BIT(event);
+		posted_at[event] = timebase_cycles();
+	}
+	crit_exit(CRIT_EVENT_POST, masking_state);
+}
+
+/*
+ * @brief Runs the handlers of all the pending events once
+ *
+ * The pending events are taken in one go, events posted while the handlers run are
+ * dispatched by the next call
+ *
+ * @return true if at least one event was dispatched
+ */
+bool events_dispatch(void)
+{
+	uint32_t ready;
+	uint32_t stamps[EVENT_COUNT];
+
+	crit_state_t masking_state = crit_enter(CRIT_EVENT_TAKE);
+	ready = pending_events;
+	pending_events = 0;
+	for (int event = 0; event < EVENT_COUNT; event++)
+	{
+		stamps[event] = posted_at[event];
+	}
+	crit_exit(CRIT_EVENT_TAKE, masking_state);
+
+	for (int event = 0; event < EVENT_COUNT; event++)
+	{
+		if ((ready & EVENT_BIT(event)) == 0)
+		{
+			continue;
+		}
+		uint32_t start = timebase_cycles();
+		if ((start - stamps[event]) > max_latency_cycles[event])
+		{
+			max_latency_cycles[event] = start - stamps[event];
+		}
+		dispatches[event]++;
+		if (handlers[event] != NULL)
+		{
+			handlers[event]((event_t)event);
+		}
+		uint32_t run = timebase_cycles() - start;
+		if (run > max_run_cycles[event])
+		{
+			max_run_cycles[event] = run;
+		}
+	}
+	return ready != 0;
+}
+
+/*
+ * @brief The main loop: dispatches events and sleeps when none is pending, never returns
+ *
+ * The pending check and the sleep are done with interrupts masked, so an event posted
+ * just before the sleep still wakes the core
+ *
+ * @return void
+ */
+void events_run(void)
+{
+	while (1)
+	{
+		events_dispatch();
+		__disable_irq();
+		if (pending_events == 0)
+		{
+			idle_wait();
+		}
+		__enable_irq();								/*The interrupt which woke the core runs here*/
+	}
+}
+
+/*
+ * @brief Prints per event the number of posts and dispatches, and the worst latency
+ * from post to dispatch and the worst handler run time
+ *
+ * @return void
+ */
+void events_report(void)
+{
+	printf("Event\tPosts\tMerged\tDispatched\tMax latency(us)\tMax run(us)\n\r");
+	for (int event = 0; event < EVENT_COUNT; event++)
+	{
+		printf("%s\t%lu\t%lu\t%lu\t\t%lu\t\t%lu\n\r", event_names[event], (unsigned long)posts[event],
+				(unsigned long)merged[event], (unsigned long)dispatches[event],
+				(unsigned long)timebase_cycles_to_us(max_latency_cycles[event]),
+				(unsigned long)timebase_cycles_to_us(max_run_cycles[event]));
+	}
+}
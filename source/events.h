@@ -0,0 +1,73 @@
+/**
+ * @file    events.h
+ * @brief   This header file consists of the event identifiers and function prototypes of the
+ * 			event queue which drives the run-to-completion main loop
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * Interrupt handlers post events, the main loop dispatches them one after the other to the
+ * registered handlers and sleeps in WFI when none is pending. A handler runs to completion
+ * and never waits, so the latency to any event is bounded by the longest handler. Posting
+ * an event which is already pending is counted and merged in to the pending one.
+ */
+
+#ifndef EVENTS_H_
+#define EVENTS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum						/*In dispatch order, earlier events are handled first*/
+{
+	EVENT_TIMER = 0,				/*A software timer expired, posted by the systick*/
+	EVENT_SWITCH,					/*The switch was pressed, posted by the PORTD interrupt*/
+	EVENT_SAMPLE,					/*An accelerometer sample is due*/
+	EVENT_UART_RX,					/*Characters received, posted by the UART interrupt*/
+	EVENT_COUNT
+} event_t;
+
+typedef void (*event_handler_t)(event_t event);
+
+
+/*
+ * @brief Registers the handler run when an event is dispatched, replacing any previous one
+ *
+ * @param1 event event to handle
+ * @param2 handler function run from the main loop, NULL to ignore the event
+ * @return void
+ */
+void event_register(event_t event, event_handler_t handler);
+
+/*
+ * @brief Marks an event as pending, safe to call from interrupt handlers
+ *
+ * @param event event to post
+ * @return void
+ */
+void event_post(event_t event);
+
+/*
+ * @brief Runs the handlers of all the pending events once
+ *
+ * @return true if at least one event was dispatched
+ */
+bool events_dispatch(void);
+
+/*
+ * @brief The main loop: dispatches events and sleeps when none is pending, never returns
+ *
+ * @return void
+ */
+void events_run(void);
+
+/*
+ * @brief Prints per event the number of posts and dispatches, and the worst latency
+ * from post to dispatch and the worst handler run time
+ *
+ * @return void
+ */
+void events_report(void);
+
+
+#endif /* EVENTS_H_ */
@@ -0,0 +1,379 @@
+/**
+ * @file    fmt.c
+ * @brief   This source file consists of function definitions of the integer-only console
+ * 			formatter, which writes decimal, hex, fixed-point and string output straight in
+ * 			to the transmit queue
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * printf goes through the library formatter, built with float support, and then through
+ * __sys_write, which waits for the transmit queue to drain before every call. These
+ * functions convert the few things the console prints without any division (the M0+ has
+ * no divide instruction), and hand literal text and digits to uart0_put(), which only
+ * waits when the queue is full.
+ *
+ * Built with FMT_HOST defined the output goes to fmt_host_write() instead, so the same
+ * code can be benchmarked on the host, see tools/fmtbench.c
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include "fmt.h"
+
+#if defined(FMT_HOST)
+void fmt_host_write(const char *text, uint32_t size);
+#define FMT_WRITE(text, size)	fmt_host_write((text), (size))
+#else
+#include "uart.h"
+#define FMT_WRITE(text, size)	uart0_put((text), (size))
+#endif
+
+#define FMT_DIGITS_MAX		10				/*Decimal digits of a 32 bit number*/
+#define FMT_FIELD_MAX		32				/*Widest padded field*/
+
+static const uint32_t powers_of_ten[FMT_DIGITS_MAX] =
+{
+	1000000000, 100000000, 10000000, 1000000, 100000, 10000, 1000, 100, 10, 1
+};
+static const char hex_digits[] = "0123456789ABCDEF";
+
+
+/*
+ * @brief Converts an unsigned number to decimal digits by repeated subtraction
+ *
+ * @param1 value number
+ * @param2 digits buffer of at least FMT_DIGITS_MAX characters
+ * @param3 min_digits minimum number of digits, leading zeros are added up to it
+ * @return number of digits written
+ */
+static uint32_t to_decimal(uint32_t value, char *digits, uint32_t min_digits)
+{
+	uint32_t count = 0;
+	uint32_t place = 0;
+	while ((place < FMT_DIGITS_MAX - min_digits) && (value < powers_of_ten[place]))
+	{
+		place++;									/*Skips the leading zeros*/
+	}
+	for (; place < FMT_DIGITS_MAX; place++)
+	{
+		uint32_t power = powers_of_ten[place];
+		char digit = '0';
+		while (value >= power)
+		{
+			value -= power;
+			digit++;
+		}
+		digits[count++] = digit;
+	}
+	return count;
+}
+
+/*
+ * @brief Converts an unsigned number to upper or lower case hex digits
+ *
+ * @param1 value number
+ * @param2 digits buffer of at least 8 characters
+ * @param3 min_digits minimum number of digits, leading zeros are added up to it
+ * @param4 lower true for lower case digits
+ * @return number of digits written
+ */
+static uint32_t to_hex(uint32_t value, char *digits, uint32_t min_digits, bool lower)
+{
+	uint32_t count = 0;
+	for (int shift = 28; shift >= 0; shift -= 4)
+	{
+		uint32_t nibble = (value >> shift) & 0xF;
+		if ((count != 0) || (nibble != 0) || ((uint32_t)(shift / 4) < min_digits))
+		{
+			digits[count++] = hex_digits[nibble] | (lower ? 0x20 : 0);	/*Sets the lower case bit of letters, no change to digits*/
+		}
+	}
+	return count;
+}
+
+/*
+ * @brief Writes a converted number padded to a field width
+ *
+ * @param1 sign '-' or 0 for no sign
+ * @param2 digits converted digits
+ * @param3 count number of digits
+ * @param4 width field width
+ * @param5 left true to pad on the right
+ * @param6 zero true to pad with zeros after the sign instead of spaces before it
+ * @return void
+ */
+static void write_field(char sign, const char *digits, uint32_t count, uint32_t width, bool left, bool zero)
+{
+	char field[FMT_FIELD_MAX + 1];
+	uint32_t length = count + ((sign != 0) ? 1 : 0);
+	uint32_t pad = (width > length) ? (width - length) : 0;
+	uint32_t used = 0;
+
+	if (pad > FMT_FIELD_MAX - length)
+	{
+		pad = FMT_FIELD_MAX - length;
+	}
+	if (!left && !zero)
+	{
+		while (pad > 0)
+		{
+			field[used++] = ' ';
+			pad--;
+		}
+	}
+	if (sign != 0)
+	{
+		field[used++] = sign;
+	}
+	if (!left && zero)
+	{
+		while (pad > 0)
+		{
+			field[used++] = '0';
+			pad--;
+		}
+	}
+	for (uint32_t i = 0; i < count; i++)
+	{
+		field[used++] = digits[i];
+	}
+	while (pad > 0)
+	{
+		field[used++] = ' ';
+		pad--;
+	}
+	FMT_WRITE(field, used);
+}
+
+/*
+ * @brief Writes a string
+ *
+ * @param text null terminated string
+ * @return void
+ */
+void fmt_str(const char *text)
+{
+	uint32_t length = 0;
+	while (text[length] != '\0')
+	{
+		length++;
+	}
+	FMT_WRITE(text, length);
+}
+
+/*
+ * @brief Writes a single character
+ *
+ * @param c character
+ * @return void
+ */
+void fmt_char(char c)
+{
+	FMT_WRITE(&c, 1);
+}
+
+/*
+ * @brief Writes a signed decimal number
+ *
+ * @param value number
+ * @return void
+ */
+void fmt_dec(int32_t value)
+{
+	char digits[FMT_DIGITS_MAX + 1];
+	uint32_t magnitude = (value < 0) ? (0U - (uint32_t)value) : (uint32_t)value;
+	uint32_t count = 0;
+
+	if (value < 0)
+	{
+		digits[count++] = '-';
+	}
+	count += to_decimal(magnitude, &digits[count], 1);
+	FMT_WRITE(digits, count);
+}
+
+/*
+ * @brief Writes an unsigned decimal number
+ *
+ * @param value number
+ * @return void
+ */
+void fmt_udec(uint32_t value)
+{
+	char digits[FMT_DIGITS_MAX];
+	FMT_WRITE(digits, to_decimal(value, digits, 1));
+}
+
+/*
+ * @brief Writes an upper case hex number, zero padded to a number of digits
+ *
+ * @param1 value number
+ * @param2 digits minimum number of digits, 0 for no padding
+ * @return void
+ */
+void fmt_hex(uint32_t value, uint8_t digits)
+{
+	char text[8];
+	FMT_WRITE(text, to_hex(value, text, (digits != 0) ? digits : 1, false));
+}
+
+/*
+ * @brief Writes a fixed-point number, for example an angle held in tenths of a degree
+ *
+ * @param1 value number scaled by 10^decimals
+ * @param2 decimals number of digits after the point, up to 9
+ * @return void
+ */
+void fmt_fixed(int32_t value, uint8_t decimals)
+{
+	char digits[FMT_DIGITS_MAX + 2];
+	uint32_t magnitude = (value < 0) ? (0U - (uint32_t)value) : (uint32_t)value;
+	uint32_t count = 0;
+	uint32_t length;
+
+	if (decimals > FMT_DIGITS_MAX - 1)
+	{
+		decimals = FMT_DIGITS_MAX - 1;
+	}
+	if (value < 0)
+	{
+		digits[count++] = '-';
+	}
+	length = to_decimal(magnitude, &digits[count], decimals + 1);	/*At least one digit before the point*/
+	if (decimals != 0)
+	{
+		uint32_t point = count + length - decimals;
+		for (uint32_t i = count + length; i > point; i--)
+		{
+			digits[i] = digits[i - 1];								/*Opens a gap for the point*/
+		}
+		digits[point] = '.';
+		length++;
+	}
+	FMT_WRITE(digits, count + length);
+}
+
+/*
+ * @brief printf replacement for the conversions the console uses
+ *
+ * @param format format string
+ * @return void
+ */
+void fmt_printf(const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+
+	while (*format != '\0')
+	{
+		const char *literal = format;
+		while ((*format != '\0') && (*format != '%'))
+		{
+			format++;
+		}
+		if (format != literal)
+		{
+			FMT_WRITE(literal, (uint32_t)(format - literal));	/*Text between conversions is copied as it is*/
+		}
+		if (*format == '\0')
+		{
+			break;
+		}
+
+		const char *start = format++;
+		bool left = false;
+		bool zero = false;
+		uint32_t width = 0;
+		char digits[FMT_DIGITS_MAX];
+		uint32_t count;
+		char sign = 0;
+
+		for (;; format++)
+		{
+			if (*format == '-')
+			{
+				left = true;
+			}
+			else if (*format == '0')
+			{
+				zero = true;
+			}
+			else
+			{
+				break;
+			}
+		}
+		while ((*format >= '0') && (*format <= '9'))
+		{
+			width = (width * 10) + (uint32_t)(*format++ - '0');
+		}
+		while (*format == 'l')
+		{
+			format++;
+		}
+
+		switch (*format)
+		{
+		case 'd':
+		case 'i':
+		{
+			int value = va_arg(args, int);
+			if (value < 0)
+			{
+				sign = '-';
+			}
+			count = to_decimal((value < 0) ? (0U - (uint32_t)value) : (uint32_t)value, digits, 1);
+			write_field(sign, digits, count, width, left, zero);
+			break;
+		}
+		case 'u':
+			count = to_decimal(va_arg(args, unsigned int), digits, 1);
+			write_field(0, digits, count, width, left, zero);
+			break;
+		case 'x':
+		case 'X':
+			count = to_hex(va_arg(args, unsigned int), digits, 1, *format == 'x');
+			write_field(0, digits, count, width, left, zero);
+			break;
+		case 'c':
+			digits[0] = (char)va_arg(args, int);
+			write_field(0, digits, 1, width, left, false);
+			break;
+		case 's':
+		{
+			const char *text = va_arg(args, const char *);
+			uint32_t length = 0;
+			while (text[length] != '\0')
+			{
+				length++;
+			}
+			if (left || (width <= length))
+			{
+				FMT_WRITE(text, length);
+			}
+			if (width > length)
+			{
+				write_field(0, digits, 0, width - length, false, false);
+			}
+			if (!left && (width > length))
+			{
+				FMT_WRITE(text, length);
+			}
+			break;
+		}
+		case '%':
+			FMT_WRITE("%", 1);
+			break;
+		default:									/*Unsupported conversion, shown as it is*/
+			if (*format == '\0')
+			{
+				format--;
+			}
+			FMT_WRITE(start, (uint32_t)(format + 1 - start));
+			break;
+		}
+		format++;
+	}
+	va_end(args);
+}
@@ -0,0 +1,81 @@
+/**
+ * @file    fmt.h
+ * @brief   This header file consists of function prototypes of the integer-only console
+ * 			formatter, which writes decimal, hex, fixed-point and string output straight in
+ * 			to the transmit queue
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ */
+
+#ifndef FMT_H_
+#define FMT_H_
+
+#include <stdint.h>
+
+/*
+ * @brief Writes a string
+ *
+ * @param text null terminated string
+ * @return void
+ */
+void fmt_str(const char *text);
+
+/*
+ * @brief Writes a single character
+ *
+ * @param c character
+ * @return void
+ */
+void fmt_char(char c);
+
+/*
+ * @brief Writes a signed decimal number
+ *
+ * @param value number
+ * @return void
+ */
+void fmt_dec(int32_t value);
+
+/*
+ * @brief Writes an unsigned decimal number
+ *
+ * @param value number
+ * @return void
+ */
+void fmt_udec(uint32_t value);
+
+/*
+ * @brief Writes an upper case hex number, zero padded to a number of digits
+ *
+ * @param1 value number
+ * @param2 digits minimum number of digits, 0 for no padding
+ * @return void
+ */
+void fmt_hex(uint32_t value, uint8_t digits);
+
+/*
+ * @brief Writes a fixed-point number, for example an angle held in tenths of a degree
+ *
+ * fmt_fixed(-905, 1) writes -90.5
+ *
+ * @param1 value number scaled by 10^decimals
+ * @param2 decimals number of digits after the point, up to 9
+ * @return void
+ */
+void fmt_fixed(int32_t value, uint8_t decimals);
+
+/*
+ * @brief printf replacement for the conversions the console uses
+ *
+ * Handles %d %i %u %x %X %c %s and %%, with the - and 0 flags, a field width and
+ * the l modifier, which is ignored as int and long are both 32 bits. There is no
+ * floating point support, use fmt_fixed() instead
+ *
+ * @param format format string
+ * @return void
+ */
+void fmt_printf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+
+#endif /* FMT_H_ */
@@ -0,0 +1,73 @@
+/**
+ * @file    guidance.c
+ * @brief   This source file consists of the compile-time colour ramp tables and the integer
+ * 			guidance colour lookup used by the set command
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * Each ramp entry linearly mixes the two end colours and then applies gamma correction,
+ * so equal steps along the ramp look like equal steps in brightness. Gamma 2.2 is
+ * approximated by 0.8*x^2 + 0.2*x^3 (within 1% of full scale), which keeps every entry
+ * an integer constant expression.
+ */
+
+#include "guidance.h"
+#include "ramfunc.h"
+#include "probe.h"
+
+#define FULL_SCALE 255
+
+#define CHANNEL(rgb, shift)   (((rgb) >> (shift)) & 0xFF)
+#define MIX(start, end, i)    (((start) * (GUIDANCE_STEPS - (i)) + (end) * (i) + (GUIDANCE_STEPS / 2)) / GUIDANCE_STEPS)
+#define GAMMA_DIVISOR         (5 * FULL_SCALE * FULL_SCALE)
+#define GAMMA(x)              ((4 * FULL_SCALE * (x) * (x) + (x) * (x) * (x) + (GAMMA_DIVISOR / 2)) / GAMMA_DIVISOR)
+
+#define RAMP_CHANNEL(start, end, shift, i)  GAMMA(MIX(CHANNEL(start, shift), CHANNEL(end, shift), (i)))
+#define RAMP_ENTRY(start, end, i)   {RAMP_CHANNEL(start, end, 16, i), RAMP_CHANNEL(start, end, 8, i), \
+									 RAMP_CHANNEL(start, end, 0, i)}
+#define RAMP_8(start, end, i)       RAMP_ENTRY(start, end, (i)), RAMP_ENTRY(start, end, (i) + 1), \
+									RAMP_ENTRY(start, end, (i) + 2), RAMP_ENTRY(start, end, (i) + 3), \
+									RAMP_ENTRY(start, end, (i) + 4), RAMP_ENTRY(start, end, (i) + 5), \
+									RAMP_ENTRY(start, end, (i) + 6), RAMP_ENTRY(start, end, (i) + 7)
+#define RAMP(start, end)            {RAMP_8(start, end, 0), RAMP_8(start, end, 8), RAMP_8(start, end, 16), \
+									 RAMP_8(start, end, 24), RAMP_ENTRY(start, end, 32)}
+
+#if GUIDANCE_STEPS != 32
+#error "RAMP() writes out 33 entries, update it together with GUIDANCE_STEPS"
+#endif
+
+static RAMDATA const guidance_colour_t ramps[GUIDANCE_NUM_RAMPS][GUIDANCE_STEPS + 1] =
+{
+	RAMP(GUIDANCE_FAR_START, GUIDANCE_FAR_END),
+	RAMP(GUIDANCE_CLOSE_START, GUIDANCE_CLOSE_END)
+};
+
+
+/*
+ * @brief Looks up the gamma corrected colour for a position along a ramp
+ *
+ * @param1 ramp the ramp to use
+ * @param2 position how far along the ramp, clamped to 0..span
+ * @param3 span length of the ramp, the end colour is returned if it is not positive
+ * @return the colour to show, 0-255 per channel
+ */
+RAMFUNC const guidance_colour_t *guidance_colour(guidance_ramp_t ramp, int position, int span)
+{
+	int index = GUIDANCE_STEPS;
+	PROBE_HIGH(PROBE_GUIDANCE);
+	if (span > 0)
+	{
+		if (position < 0)
+		{
+			position = 0;
+		}
+		else if (position > span)
+		{
+			position = span;
+		}
+		index = (position * GUIDANCE_STEPS) / span;
+	}
+	PROBE_LOW(PROBE_GUIDANCE);
+	return &ramps[ramp][index];
+}
@@ -0,0 +1,54 @@
+/**
+ * @file    guidance.h
+ * @brief   This header file consists of the colour ramp configuration and function prototype
+ * 			of the integer guidance colour lookup used by the set command
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ */
+
+#ifndef GUIDANCE_H_
+#define GUIDANCE_H_
+
+#include <stdint.h>
+
+/*
+ * Ramp end colours as 0xRRGGBB, the tables are built from these at compile time.
+ * The far ramp is used while the board is still between the old zero and the calibrated
+ * reference, the close ramp while moving from the reference to the requested angle.
+ */
+#define GUIDANCE_FAR_START    0x0000FF		/*Blue at the old zero*/
+#define GUIDANCE_FAR_END      0x00FF00		/*Green at the calibrated reference*/
+#define GUIDANCE_CLOSE_START  0x00FF00		/*Green at the calibrated reference*/
+#define GUIDANCE_CLOSE_END    0xFF0000		/*Red at the requested angle*/
+
+#define GUIDANCE_STEPS 32					/*Entries per ramp are GUIDANCE_STEPS+1, the tables are written out for 32*/
+
+typedef enum
+{
+	GUIDANCE_FAR = 0,
+	GUIDANCE_CLOSE,
+	GUIDANCE_NUM_RAMPS
+} guidance_ramp_t;
+
+typedef struct
+{
+	uint8_t red;
+	uint8_t green;
+	uint8_t blue;
+} guidance_colour_t;
+
+#define GUIDANCE_TABLE_BYTES (GUIDANCE_NUM_RAMPS * (GUIDANCE_STEPS + 1) * sizeof(guidance_colour_t))
+
+
+/*
+ * @brief Looks up the gamma corrected colour for a position along a ramp
+ *
+ * @param1 ramp the ramp to use
+ * @param2 position how far along the ramp, clamped to 0..span
+ * @param3 span length of the ramp, the end colour is returned if it is not positive
+ * @return the colour to show, 0-255 per channel
+ */
+const guidance_colour_t *guidance_colour(guidance_ramp_t ramp, int position, int span);
+
+#endif /* GUIDANCE_H_ */
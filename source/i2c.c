@@ -11,11 +11,44 @@
 
 #include <MKL25Z4.H>
 #include "i2c.h"
+#include "sysclock.h"
+#include "ramfunc.h"
 
 #define DETECT_TIME 200
+#define I2C_BAUD_RATE (400000U)			/*Fast mode, the maximum of the MMA8451*/
+#define I2C_NUM_ICR (64)
+
+/*SCL divider for every value of I2C_F[ICR], KL25Z Reference Manual table 38-41*/
+static const uint16_t scl_divider[I2C_NUM_ICR] =
+{
+	20, 22, 24, 26, 28, 30, 34, 40, 28, 32, 36, 40, 44, 48, 56, 68,
+	48, 56, 64, 72, 80, 88, 104, 128, 80, 96, 112, 128, 144, 160, 192, 240,
+	160, 192, 224, 256, 288, 320, 384, 480, 320, 384, 448, 512, 576, 640, 768, 960,
+	640, 768, 896, 1024, 1152, 1280, 1536, 1920, 1280, 1536, 1792, 2048, 2304, 2560, 3072, 3840
+};
+
 int lock_detect=0;
 int i2c_lock=0;
 
+/*
+ * @brief Selects the ICR giving the fastest SCL not above I2C_BAUD_RATE from the bus clock
+ *
+ * @return ICR value to be loaded in I2C0->F
+ */
+static uint8_t i2c_select_icr(void)
+{
+	uint32_t wanted = (sysclock_profile()->bus_hz + I2C_BAUD_RATE - 1) / I2C_BAUD_RATE;
+	uint8_t best = I2C_NUM_ICR - 1;
+	for (uint8_t icr = 0; icr < I2C_NUM_ICR; icr++)
+	{
+		if ((scl_divider[icr] >= wanted) && (scl_divider[icr] < scl_divider[best]))
+		{
+			best = icr;
+		}
+	}
+	return best;
+}
+
 /*
  * @brief Initialize I2C protocol
  *
@@ -28,7 +61,7 @@ void i2c_init(void)
 	SIM->SCGC5 |= (SIM_SCGC5_PORTE_MASK);
 	PORTE->PCR[24] |= PORT_PCR_MUX(5);
 	PORTE->PCR[25] |= PORT_PCR_MUX(5);					/*setting the  pins to I2C function*/
- 	I2C0->F = (I2C_F_ICR(0x10) | I2C_F_MULT(0));		/*Set 100k baud rate*/
+ 	I2C0->F = (I2C_F_ICR(i2c_select_icr()) | I2C_F_MULT(0));	/*Set the baud rate from the bus clock*/
 	I2C0->C1 |= (I2C_C1_IICEN_MASK);			  		/*setting to master mode*/
 	I2C0->C2 |= (I2C_C2_HDRS_MASK);
 }
@@ -80,7 +113,7 @@ void i2c_busy(void)
  * @return void
  */
 
-void i2c_wait(void)
+RAMFUNC void i2c_wait(void)
 {
 	lock_detect = 0;
 	while(((I2C0->S & I2C_S_IICIF_MASK)==0) & (lock_detect < DETECT_TIME))
@@ -98,7 +131,7 @@ void i2c_wait(void)
  * @return void
  */
 
-void i2c_start()
+RAMFUNC void i2c_start()
 {
 	I2C_TRAN;							/*set to transmit mode */
 	I2C_M_START;						/*send start	*/
@@ -112,7 +145,7 @@ void i2c_start()
  * @return void
  */
 
-void i2c_read_setup(uint8_t dev, uint8_t address)
+RAMFUNC void i2c_read_setup(uint8_t dev, uint8_t address)
 {
 	I2C0->D = dev;			 /*send dev address	*/
 	I2C_WAIT				/*wait for completion */
@@ -132,7 +165,7 @@ void i2c_read_setup(uint8_t dev, uint8_t address)
  * @return void
  */
 
-uint8_t i2c_repeated_read(uint8_t isLastRead)
+RAMFUNC uint8_t i2c_repeated_read(uint8_t isLastRead)
 {
 	uint8_t data;
 	lock_detect = 0;
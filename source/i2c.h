@@ -44,6 +44,13 @@ void i2c_init(void);
  */
 void i2c_busy(void);
 
+/*
+ * @brief Wait for the i2c packet to be received
+ *
+ * @return void
+ */
+void i2c_wait(void);
+
 /*
  * @brief send i2c start sequence
  *
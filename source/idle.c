@@ -0,0 +1,153 @@
+/**
+ * @file    idle.c
+ * @brief   This source file consists of function definitions of the central idle hook and
+ * 			the CPU utilization accounting
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ */
+
+#include <stdio.h>
+#include "idle.h"
+#include "critical.h"
+#include "MKL25Z4.h"
+
+#define PERCENT 100
+
+static const char *task_names[CPU_NUM_TASKS] = {"other", "idle", "sampling", "commands", "timers"};
+
+static volatile uint32_t task_cycles[CPU_NUM_TASKS];	/*Running totals, wrap is fine as only deltas are used*/
+static uint32_t window_start_cycles[CPU_NUM_TASKS];		/*Totals when the current window started*/
+static uint32_t window_cycles[CPU_NUM_TASKS];			/*Per-task cycles of the last complete window*/
+static uint32_t window_start = 0;						/*Timebase cycles when the current window started*/
+static uint32_t window_length = 0;						/*Cycles in the last complete window*/
+static cpu_task_t current_task = CPU_TASK_OTHER;
+static uint32_t last_switch = 0;						/*Timebase cycles of the last charge*/
+
+
+/*
+ * @brief Charges the cycles since the last charge to the current task
+ *
+ * @return void
+ */
+static void charge_current_task(void)
+{
+	crit_state_t masking_state = crit_enter(CRIT_CPU_LOAD);	/*The systick charges too when it closes a window*/
+	uint32_t now = timebase_cycles();
+	task_cycles[current_task] += now - last_switch;
+	last_switch = now;
+	crit_exit(CRIT_CPU_LOAD, masking_state);
+}
+
+/*
+ * @brief Sleeps until the next interrupt, counting the time asleep as idle
+ *
+ * @return void
+ */
+void idle_wait(void)
+{
+	uint32_t masking_state = __get_PRIMASK();
+	__disable_irq();							/*A pending interrupt still wakes WFI, its handler runs after the accounting*/
+	charge_current_task();
+	__DSB();
+	__WFI();
+	uint32_t now = timebase_cycles();
+	task_cycles[CPU_TASK_IDLE] += now - last_switch;
+	last_switch = now;
+	__set_PRIMASK(masking_state);
+}
+
+/*
+ * @brief Charges the time so far to the current task and makes task current
+ *
+ * @param task task the following time is charged to
+ * @return the task which was current, to be passed to cpu_task_exit()
+ */
+cpu_task_t cpu_task_enter(cpu_task_t task)
+{
+	cpu_task_t previous = current_task;
+	charge_current_task();
+	current_task = task;
+	return previous;
+}
+
+/*
+ * @brief Charges the time so far to the current task and makes previous current again
+ *
+ * @param previous task returned by the matching cpu_task_enter()
+ * @return void
+ */
+void cpu_task_exit(cpu_task_t previous)
+{
+	charge_current_task();
+	current_task = previous;
+}
+
+/*
+ * @brief Called from the systick handler every tick to close the load window
+ *
+ * The current task is charged first so time spent in a long task shows up in the window
+ * it was spent in
+ *
+ * @param now current tick count
+ * @return void
+ */
+void cpu_load_tick(ticktime now)
+{
+	if ((now % CPU_LOAD_WINDOW_MS) != 0)
+	{
+		return;
+	}
+	charge_current_task();
+	uint32_t cycles = timebase_cycles();
+	window_length = cycles - window_start;
+	window_start = cycles;
+	for (int task = 0; task < CPU_NUM_TASKS; task++)
+	{
+		window_cycles[task] = task_cycles[task] - window_start_cycles[task];
+		window_start_cycles[task] = task_cycles[task];
+	}
+}
+
+/*
+ * @brief Percentage of the last complete window
+ *
+ * @return share in percent
+ */
+static uint32_t window_percent(uint32_t cycles)
+{
+	if (window_length == 0)
+	{
+		return 0;
+	}
+	return (uint32_t)(((uint64_t)cycles * PERCENT) / window_length);
+}
+
+/*
+ * @brief CPU load over the last complete window
+ *
+ * @return load in percent, 0 to 100
+ */
+uint32_t cpu_load_percent(void)
+{
+	if (window_length == 0)
+	{
+		return 0;
+	}
+	return PERCENT - window_percent(window_cycles[CPU_TASK_IDLE]);
+}
+
+/*
+ * @brief Prints the CPU load and the per-task breakdown of the last complete window
+ *
+ * @return void
+ */
+void cpu_load_report(void)
+{
+	printf("CPU load %lu%% over the last %d ms\n\r", (unsigned long)cpu_load_percent(), CPU_LOAD_WINDOW_MS);
+	for (int task = 0; task < CPU_NUM_TASKS; task++)
+	{
+		printf("  %s\t%lu%%\t%lu cycles\n\r", task_names[task],
+				(unsigned long)window_percent(window_cycles[task]), (unsigned long)window_cycles[task]);
+	}
+}
@@ -0,0 +1,83 @@
+/**
+ * @file    idle.h
+ * @brief   This header file consists of function prototypes of the central idle hook and
+ * 			the CPU utilization accounting
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * Every wait loop calls idle_wait() instead of spinning, so the core sleeps in WFI and the
+ * time spent asleep is counted as idle. Busy time is charged to the task which is current,
+ * selected with cpu_task_enter()/cpu_task_exit(). The systick closes a one second window
+ * of these counters, from which the CPU load and the per-task breakdown are reported.
+ */
+
+#ifndef IDLE_H_
+#define IDLE_H_
+
+#include <stdint.h>
+#include "timer.h"
+
+typedef enum
+{
+	CPU_TASK_OTHER = 0,			/*Main loop work not charged to a task below*/
+	CPU_TASK_IDLE,				/*Asleep in idle_wait()*/
+	CPU_TASK_SAMPLING,			/*Accelerometer reads and angle computation*/
+	CPU_TASK_COMMAND,			/*Console command handlers*/
+	CPU_TASK_TIMERS,			/*Software timer callbacks*/
+	CPU_NUM_TASKS
+} cpu_task_t;
+
+#define CPU_LOAD_WINDOW_MS 1000	/*Length of the window the load is computed over*/
+
+
+/*
+ * @brief Sleeps until the next interrupt, counting the time asleep as idle
+ *
+ * The core is woken by any interrupt, including the 1 ms systick, so callers re-check
+ * their wait condition after each call. The interrupt which woke the core is handled
+ * after the idle time is counted, so handler time is not reported as idle.
+ *
+ * @return void
+ */
+void idle_wait(void);
+
+/*
+ * @brief Charges the time so far to the current task and makes task current
+ *
+ * @param task task the following time is charged to
+ * @return the task which was current, to be passed to cpu_task_exit()
+ */
+cpu_task_t cpu_task_enter(cpu_task_t task);
+
+/*
+ * @brief Charges the time so far to the current task and makes previous current again
+ *
+ * @param previous task returned by the matching cpu_task_enter()
+ * @return void
+ */
+void cpu_task_exit(cpu_task_t previous);
+
+/*
+ * @brief Called from the systick handler every tick to close the load window
+ *
+ * @param now current tick count
+ * @return void
+ */
+void cpu_load_tick(ticktime now);
+
+/*
+ * @brief CPU load over the last complete window
+ *
+ * @return load in percent, 0 to 100
+ */
+uint32_t cpu_load_percent(void);
+
+/*
+ * @brief Prints the CPU load and the per-task breakdown of the last complete window
+ *
+ * @return void
+ */
+void cpu_load_report(void);
+
+#endif /* IDLE_H_ */
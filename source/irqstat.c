@@ -0,0 +1,198 @@
+/**
+ * @file    irqstat.c
+ * @brief   This source file consists of function definitions of the per interrupt statistics:
+ * 			entry count, run time histogram and entry latency
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "irqstat.h"
+#include "sysclock.h"
+#include "ramfunc.h"
+
+/*
+ * The KL25Z implements 2 priority bits, levels 0 (highest) to 3. NVIC_SetPriority() keeps
+ * only those bits, so the effective priority is read back rather than trusting the value
+ * the driver asked for
+ */
+typedef struct
+{
+	const char *name;
+	IRQn_Type irqn;
+	bool peripheral_clock;			/*The latency is counted in peripheral clock cycles*/
+} irq_info_t;
+
+static const irq_info_t irq_info[IRQ_STAT_COUNT] =
+{
+	{"UART0", UART0_IRQn, false},
+	{"SysTick", SysTick_IRQn, false},
+	{"PORTD", PORTD_IRQn, false},
+	{"TPM2", TPM2_IRQn, true},
+	{"PendSV", PendSV_IRQn, false},
+};
+
+#if IRQ_STATS_ENABLE
+
+typedef struct
+{
+	uint32_t count;
+	uint32_t max;
+	uint64_t total;
+	uint32_t latency_count;
+	uint32_t latency_max;
+	uint64_t latency_total;
+	uint32_t histogram[IRQ_HISTOGRAM_BUCKETS];
+} irq_entry_t;
+
+static irq_entry_t irq_table[IRQ_STAT_COUNT];
+
+
+/*
+ * @brief Adds one run of a handler, called by IRQ_STAT_EXIT()
+ *
+ * A handler cannot preempt itself, so every entry is only written by its own handler. In
+ * SRAM with the handlers it is called from; a handler called as a function in thread mode,
+ * as the ram command benchmarks UART0_IRQHandler, is not counted.
+ *
+ * @param1 irq the handler
+ * @param2 start systick counter when the handler started
+ * @param3 latency cycles from pending to entry, IRQ_LATENCY_UNKNOWN if not measurable
+ * @return void
+ */
+RAMFUNC void irqstat_record(irq_stat_t irq, uint32_t start, uint32_t latency)
+{
+	uint32_t end = SysTick->VAL;
+	uint32_t cycles = start - end;					/*The systick counts down*/
+	irq_entry_t *entry = &irq_table[irq];
+	uint32_t rest;
+	int bucket = 0;
+
+	if (__get_IPSR() == 0)
+	{
+		return;
+	}
+	if (end > start)
+	{
+		cycles += SysTick->LOAD + 1;				/*Reloaded while the handler ran*/
+	}
+	if (cycles >= (1U << (IRQ_HISTOGRAM_BUCKETS - 1)))
+	{
+		bucket = IRQ_HISTOGRAM_BUCKETS - 1;
+	}
+	else
+	{
+		rest = cycles;								/*Binary search for the top bit, the M0+ has no CLZ*/
+		if (rest >= (1U << 8))
+		{
+			bucket += 8;
+			rest >>= 8;
+		}
+		if (rest >= (1U << 4))
+		{
+			bucket += 4;
+			rest >>= 4;
+		}
+		if (rest >= (1U << 2))
+		{
+			bucket += 2;
+			rest >>= 2;
+		}
+		if (rest >= (1U << 1))
+		{
+			bucket += 1;
+		}
+	}
+	entry->histogram[bucket]++;
+	entry->count++;
+	entry->total += cycles;
+	if (cycles > entry->max)
+	{
+		entry->max = cycles;
+	}
+
+	if (latency != IRQ_LATENCY_UNKNOWN)
+	{
+		entry->latency_count++;
+		entry->latency_total += latency;
+		if (latency > entry->latency_max)
+		{
+			entry->latency_max = latency;
+		}
+	}
+}
+
+/*
+ * @brief Prints per interrupt its effective NVIC priority, the number of entries, the run
+ * time and entry latency, and a histogram of the run time, then clears the statistics
+ *
+ * @return void
+ */
+void irqstat_report(void)
+{
+	irq_entry_t snapshot[IRQ_STAT_COUNT];
+	const sysclock_profile_t *clock = sysclock_profile();
+	uint32_t peripheral_to_core = clock->core_hz / clock->peripheral_hz;
+
+	uint32_t masking_state = __get_PRIMASK();
+	__disable_irq();
+	memcpy(snapshot, irq_table, sizeof(irq_table));
+	memset(irq_table, 0, sizeof(irq_table));
+	__set_PRIMASK(masking_state);
+
+	printf("IRQ\tPrio\tCount\tMax\tMean\tLatency max\tmean (core cycles at %lu Hz)\n\r",
+			(unsigned long)clock->core_hz);
+	for (int irq = 0; irq < IRQ_STAT_COUNT; irq++)
+	{
+		irq_entry_t *entry = &snapshot[irq];
+		uint32_t scale = irq_info[irq].peripheral_clock ? peripheral_to_core : 1;
+
+		printf("%s\t%lu\t%lu", irq_info[irq].name, (unsigned long)NVIC_GetPriority(irq_info[irq].irqn),
+				(unsigned long)entry->count);
+		if (entry->count == 0)
+		{
+			printf("\n\r");
+			continue;
+		}
+		printf("\t%lu\t%lu", (unsigned long)entry->max, (unsigned long)(entry->total / entry->count));
+		if (entry->latency_count != 0)
+		{
+			printf("\t%lu\t\t%lu\n\r", (unsigned long)(entry->latency_max * scale),
+					(unsigned long)((entry->latency_total / entry->latency_count) * scale));
+		}
+		else
+		{
+			printf("\tn/a\n\r");
+		}
+		printf("  log2 histogram:");
+		for (int bucket = 0; bucket < IRQ_HISTOGRAM_BUCKETS; bucket++)
+		{
+			if (entry->histogram[bucket] != 0)
+			{
+				printf(" [%lu+]=%lu", 1UL << bucket, (unsigned long)entry->histogram[bucket]);
+			}
+		}
+		printf("\n\r");
+	}
+}
+
+#else
+
+/*
+ * @brief Prints per interrupt its effective NVIC priority
+ *
+ * @return void
+ */
+void irqstat_report(void)
+{
+	printf("IRQ\tPrio (statistics are not enabled in this build)\n\r");
+	for (int irq = 0; irq < IRQ_STAT_COUNT; irq++)
+	{
+		printf("%s\t%lu\n\r", irq_info[irq].name, (unsigned long)NVIC_GetPriority(irq_info[irq].irqn));
+	}
+}
+
+#endif
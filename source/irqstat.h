@@ -0,0 +1,89 @@
+/**
+ * @file    irqstat.h
+ * @brief   This header file consists of the instrumentation macros and function prototypes of
+ * 			the per interrupt statistics: entry count, run time histogram and entry latency
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * A handler starts with IRQ_STAT_ENTER(latency) and leaves through IRQ_STAT_EXIT(irq) at
+ * its single exit. The run time is taken from the systick counter, in core cycles, and
+ * includes the time spent in higher priority handlers nested in it; it is measured modulo
+ * the 1 ms systick period, far longer than any handler should take.
+ *
+ * The latency from the interrupt becoming pending to the handler starting is only known
+ * where the hardware counts from that moment: the systick counter restarts from LOAD when
+ * it pends the systick, and the TPM counter restarts from 0 when it flags the overflow.
+ * The other handlers pass IRQ_LATENCY_UNKNOWN.
+ *
+ * Only runs in handler mode are counted, so a handler called as a function from thread
+ * mode, as a benchmark does, leaves the statistics alone.
+ *
+ * Enabled in Debug builds, define IRQ_STATS_ENABLE as 0 or 1 to override.
+ */
+
+#ifndef IRQSTAT_H_
+#define IRQSTAT_H_
+
+#include <stdint.h>
+#include "MKL25Z4.h"
+
+#if !defined(IRQ_STATS_ENABLE)
+#if defined(DEBUG)
+#define IRQ_STATS_ENABLE 1
+#else
+#define IRQ_STATS_ENABLE 0
+#endif
+#endif
+
+#define IRQ_HISTOGRAM_BUCKETS 16	/*Bucket n counts runs of 2^n to 2^(n+1)-1 cycles, the last one everything above*/
+#define IRQ_LATENCY_UNKNOWN 0xFFFFFFFFU
+
+typedef enum
+{
+	IRQ_STAT_UART0 = 0,
+	IRQ_STAT_SYSTICK,
+	IRQ_STAT_PORTD,
+	IRQ_STAT_TPM2,
+	IRQ_STAT_PENDSV,
+	IRQ_STAT_COUNT
+} irq_stat_t;
+
+#if IRQ_STATS_ENABLE
+
+/*Core cycles since the systick wrapped and pended its interrupt*/
+#define IRQ_LATENCY_SYSTICK			(SysTick->LOAD - irq_stat_start)
+/*Peripheral clock cycles since a TPM overflowed, converted to core cycles by the report*/
+#define IRQ_LATENCY_TPM(tpm)		((uint32_t)(tpm)->CNT << ((tpm)->SC & TPM_SC_PS_MASK))
+
+#define IRQ_STAT_ENTER(latency)		uint32_t irq_stat_start = SysTick->VAL; \
+									uint32_t irq_stat_latency = (latency)
+#define IRQ_STAT_EXIT(irq)			irqstat_record((irq), irq_stat_start, irq_stat_latency)
+
+/*
+ * @brief Adds one run of a handler, called by IRQ_STAT_EXIT()
+ *
+ * @param1 irq the handler
+ * @param2 start systick counter when the handler started
+ * @param3 latency cycles from pending to entry, IRQ_LATENCY_UNKNOWN if not measurable
+ * @return void
+ */
+void irqstat_record(irq_stat_t irq, uint32_t start, uint32_t latency);
+
+#else
+
+#define IRQ_STAT_ENTER(latency)
+#define IRQ_STAT_EXIT(irq)
+
+#endif
+
+/*
+ * @brief Prints per interrupt its effective NVIC priority, the number of entries, the run
+ * time and entry latency, and a histogram of the run time, then clears the statistics
+ *
+ * @return void
+ */
+void irqstat_report(void);
+
+
+#endif /* IRQSTAT_H_ */
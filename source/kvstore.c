@@ -0,0 +1,325 @@
+/**
+ * @file    kvstore.c
+ * @brief   This source file consists of function definitions of the log-structured key/value
+ * 			store kept in the reserved flash sector pair
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * Sector layout: an 8 byte header (magic, sequence number) followed by records. A record
+ * is a longword {key, length, CRC-16} followed by the value padded to a longword. An erased
+ * longword ends the log.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "kvstore.h"
+#include "nvm.h"
+#include "blog.h"
+
+#define KV_MAGIC        0x3153564Bu		/*"KVS1"*/
+#define KV_HEADER_SIZE  sizeof(kv_sector_header_t)
+#define KV_RECORD_SIZE(length)	(sizeof(kv_record_header_t) + (((length) + NVM_PROGRAM_UNIT - 1) & ~(NVM_PROGRAM_UNIT - 1)))
+#define CRC16_POLY      0x1021			/*CCITT*/
+#define CRC16_INIT      0xFFFF
+
+typedef struct
+{
+	uint32_t magic;
+	uint32_t sequence;					/*Higher is newer, the newest valid sector is active*/
+} kv_sector_header_t;
+
+typedef struct
+{
+	uint8_t key;
+	uint8_t length;
+	uint16_t crc;						/*Over key, length and value*/
+} kv_record_header_t;
+
+static bool kv_ready = false;
+static uint32_t active_address;
+static uint32_t active_sequence;
+static uint32_t write_offset;			/*Next free byte in the active sector*/
+static uint32_t index_address[KV_NUM_KEYS];	/*Latest valid record of every key, 0 if none*/
+static uint32_t records = 0;			/*Valid records in the active sector*/
+static uint32_t skipped = 0;			/*Records with a bad CRC*/
+static uint32_t compactions = 0;		/*Since reset*/
+
+
+/*
+ * @brief CRC-16/CCITT of a record
+ *
+ * @param1 key record key
+ * @param2 length value length
+ * @param3 value value bytes
+ * @return CRC
+ */
+static uint16_t record_crc(uint8_t key, uint8_t length, const uint8_t *value)
+{
+	uint8_t head[2] = {key, length};
+	uint16_t crc = CRC16_INIT;
+	for (uint32_t i = 0; i < (uint32_t)(2 + length); i++)
+	{
+		crc ^= (uint16_t)((i < 2) ? head[i] : value[i - 2]) << 8;
+		for (int bit = 0; bit < 8; bit++)
+		{
+			crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ CRC16_POLY) : (uint16_t)(crc << 1);
+		}
+	}
+	return crc;
+}
+
+/*
+ * @brief Address of a sector of the pair
+ *
+ * @param sector 0 or 1
+ * @return flash address
+ */
+static uint32_t sector_address(uint32_t sector)
+{
+	return NVM_KV_ADDRESS + (sector * NVM_SECTOR_SIZE);
+}
+
+/*
+ * @brief Scans the records of the active sector, builds the index and finds the end of the log
+ *
+ * @return void
+ */
+static void scan_active(void)
+{
+	memset(index_address, 0, sizeof(index_address));
+	records = 0;
+	skipped = 0;
+	write_offset = KV_HEADER_SIZE;
+	while (write_offset + sizeof(kv_record_header_t) <= NVM_SECTOR_SIZE)
+	{
+		uint32_t address = active_address + write_offset;
+		if (*(const uint32_t *)address == NVM_ERASED_WORD)
+		{
+			break;
+		}
+		const kv_record_header_t *record = (const kv_record_header_t *)address;
+		uint32_t size = KV_RECORD_SIZE(record->length);
+		if (write_offset + size > NVM_SECTOR_SIZE)
+		{
+			write_offset = NVM_SECTOR_SIZE;		/*Corrupted length, treat the sector as full*/
+			break;
+		}
+		if ((record->key < KV_NUM_KEYS) && (record->length <= KV_MAX_VALUE) &&
+			(record->crc == record_crc(record->key, record->length, (const uint8_t *)(record + 1))))
+		{
+			index_address[record->key] = address;
+			records++;
+		}
+		else
+		{
+			skipped++;
+		}
+		write_offset += size;
+	}
+}
+
+/*
+ * @brief Erases a sector and programs its header
+ *
+ * @param1 address sector address
+ * @param2 sequence sequence number of the header
+ * @return true if the sector is ready
+ */
+static bool format_sector(uint32_t address, uint32_t sequence)
+{
+	kv_sector_header_t header = {KV_MAGIC, sequence};
+	return nvm_erase(address, NVM_SECTOR_SIZE) && nvm_program(address, &header, sizeof(header));
+}
+
+/*
+ * @brief Finds the active sector once, formats the first one if neither is valid
+ *
+ * @return true if the store is usable
+ */
+static bool kv_init(void)
+{
+	if (kv_ready)
+	{
+		return true;
+	}
+	const kv_sector_header_t *found = NULL;
+	for (uint32_t sector = 0; sector < NVM_KV_SECTORS; sector++)
+	{
+		const kv_sector_header_t *header = (const kv_sector_header_t *)sector_address(sector);
+		if ((header->magic == KV_MAGIC) &&
+			((found == NULL) || ((int32_t)(header->sequence - found->sequence) > 0)))
+		{
+			found = header;
+		}
+	}
+	if (found == NULL)
+	{
+		if (!format_sector(sector_address(0), 1))
+		{
+			return false;
+		}
+		found = (const kv_sector_header_t *)sector_address(0);
+	}
+	active_address = (uint32_t)found;
+	active_sequence = found->sequence;
+	scan_active();
+	kv_ready = true;
+	return true;
+}
+
+/*
+ * @brief Programs a record at an offset of a sector
+ *
+ * @param1 address address to program
+ * @param2 key record key
+ * @param3 value value bytes
+ * @param4 length value length
+ * @return true if programmed
+ */
+static bool program_record(uint32_t address, uint8_t key, const void *value, uint8_t length)
+{
+	uint32_t buffer[KV_RECORD_SIZE(KV_MAX_VALUE) / sizeof(uint32_t)];
+	kv_record_header_t *record = (kv_record_header_t *)buffer;
+
+	memset(buffer, 0xFF, sizeof(buffer));
+	record->key = key;
+	record->length = length;
+	record->crc = record_crc(key, length, value);
+	memcpy(record + 1, value, length);
+	return nvm_program(address, buffer, KV_RECORD_SIZE(length));
+}
+
+/*
+ * @brief Copies the latest record of every key to the other sector and makes it active
+ *
+ * @return true if the other sector is active
+ */
+static bool compact(void)
+{
+	uint32_t target = (active_address == sector_address(0)) ? sector_address(1) : sector_address(0);
+	uint32_t offset = KV_HEADER_SIZE;
+
+	BLOG2("kvstore: compacting %x in to %x", active_address, target);
+	if (!nvm_erase(target, NVM_SECTOR_SIZE))
+	{
+		return false;
+	}
+	for (uint32_t key = 0; key < KV_NUM_KEYS; key++)
+	{
+		if (index_address[key] == 0)
+		{
+			continue;
+		}
+		const kv_record_header_t *record = (const kv_record_header_t *)index_address[key];
+		uint8_t value[KV_MAX_VALUE];
+		memcpy(value, record + 1, record->length);		/*Flash cannot be read while it is programmed*/
+		if (!program_record(target + offset, record->key, value, record->length))
+		{
+			return false;
+		}
+		offset += KV_RECORD_SIZE(record->length);
+	}
+
+	kv_sector_header_t header = {KV_MAGIC, active_sequence + 1};	/*Last, the copy is complete*/
+	if (!nvm_program(target, &header, sizeof(header)))
+	{
+		return false;
+	}
+	active_address = target;
+	active_sequence = header.sequence;
+	compactions++;
+	scan_active();
+	return true;
+}
+
+/*
+ * @brief Reads the latest value of a key
+ *
+ * @param1 key key to read
+ * @param2 value filled with the value
+ * @param3 size expected size of the value
+ * @return true if a value of that size is stored
+ */
+bool kv_get(kv_key_t key, void *value, uint8_t size)
+{
+	if ((key >= KV_NUM_KEYS) || !kv_init() || (index_address[key] == 0))
+	{
+		return false;
+	}
+	const kv_record_header_t *record = (const kv_record_header_t *)index_address[key];
+	if (record->length != size)
+	{
+		return false;
+	}
+	memcpy(value, record + 1, size);
+	return true;
+}
+
+/*
+ * @brief Stores a value, nothing is written if it is unchanged
+ *
+ * @param1 key key to write
+ * @param2 value new value
+ * @param3 size size of the value, up to KV_MAX_VALUE
+ * @return true if the value is stored
+ */
+bool kv_set(kv_key_t key, const void *value, uint8_t size)
+{
+	if ((key >= KV_NUM_KEYS) || (size > KV_MAX_VALUE) || !kv_init())
+	{
+		return false;
+	}
+	if (index_address[key] != 0)
+	{
+		const kv_record_header_t *record = (const kv_record_header_t *)index_address[key];
+		if ((record->length == size) && (memcmp(record + 1, value, size) == 0))
+		{
+			return true;
+		}
+	}
+	if ((write_offset + KV_RECORD_SIZE(size) > NVM_SECTOR_SIZE) && !compact())
+	{
+		return false;
+	}
+	if (write_offset + KV_RECORD_SIZE(size) > NVM_SECTOR_SIZE)
+	{
+		return false;					/*Still full, the live values do not fit*/
+	}
+	uint32_t address = active_address + write_offset;
+	write_offset += KV_RECORD_SIZE(size);		/*Even if programming fails, the longwords may be written*/
+	if (!program_record(address, key, value, size))
+	{
+		return false;
+	}
+	index_address[key] = address;
+	records++;
+	return true;
+}
+
+/*
+ * @brief Prints the active sector, its fill level and the number of compactions
+ *
+ * @return void
+ */
+void kv_report(void)
+{
+	if (!kv_init())
+	{
+		printf("Settings store is not available, the flash could not be formatted\n\r");
+		return;
+	}
+	printf("Active sector 0x%05lx, sequence %lu\n\r", (unsigned long)active_address, (unsigned long)active_sequence);
+	printf("Used %lu of %u bytes, %lu records, %lu with a bad CRC, %lu compactions since reset\n\r",
+			(unsigned long)write_offset, NVM_SECTOR_SIZE, (unsigned long)records,
+			(unsigned long)skipped, (unsigned long)compactions);
+	for (uint32_t key = 0; key < KV_NUM_KEYS; key++)
+	{
+		if (index_address[key] != 0)
+		{
+			const kv_record_header_t *record = (const kv_record_header_t *)index_address[key];
+			printf("Key %lu: %u bytes at 0x%05lx\n\r", (unsigned long)key, record->length,
+					(unsigned long)index_address[key]);
+		}
+	}
+}
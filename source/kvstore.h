@@ -0,0 +1,63 @@
+/**
+ * @file    kvstore.h
+ * @brief   This header file consists of the keys and function prototypes of the log-structured
+ * 			key/value store kept in the reserved flash sector pair
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * One sector of the pair is active. Setting a value appends a record to it, so a value
+ * can be changed many times between erases; a record with a bad CRC, as left by a reset
+ * during programming, is skipped. When the active sector is full the latest record of
+ * every key is copied to the other sector, whose header is programmed last with a higher
+ * sequence number: a reset during the compaction leaves the old sector active.
+ */
+
+#ifndef KVSTORE_H_
+#define KVSTORE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define KV_MAX_VALUE 32					/*Bytes*/
+
+typedef enum
+{
+	KV_KEY_BOOT_MODE = 0,
+	KV_KEY_SELFTEST,
+	KV_KEY_CALIBRATION,
+	KV_KEY_SENSOR_CALIBRATION,
+	KV_NUM_KEYS
+} kv_key_t;
+
+
+/*
+ * @brief Reads the latest value of a key
+ *
+ * The records are indexed on the first call, later reads do not scan the flash
+ *
+ * @param1 key key to read
+ * @param2 value filled with the value
+ * @param3 size expected size of the value
+ * @return true if a value of that size is stored
+ */
+bool kv_get(kv_key_t key, void *value, uint8_t size);
+
+/*
+ * @brief Stores a value, nothing is written if it is unchanged
+ *
+ * @param1 key key to write
+ * @param2 value new value
+ * @param3 size size of the value, up to KV_MAX_VALUE
+ * @return true if the value is stored
+ */
+bool kv_set(kv_key_t key, const void *value, uint8_t size);
+
+/*
+ * @brief Prints the active sector, its fill level and the number of compactions
+ *
+ * @return void
+ */
+void kv_report(void);
+
+#endif /* KVSTORE_H_ */
@@ -0,0 +1,141 @@
+/**
+ * @file    latency.c
+ * @brief   This source file consists of function definitions of the tilt-to-LED latency tracer
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "latency.h"
+
+#if LATENCY_TRACE_ENABLE
+
+#include "timer.h"
+#include "critical.h"
+
+#define END_TO_END        (LAT_NUM_STAGES - 1)		/*Series index of the whole pipeline*/
+#define NUM_SERIES        LAT_NUM_STAGES			/*One per stage after the first, plus end to end*/
+#define ALL_STAGES        ((1U << LAT_NUM_STAGES) - 1)
+#define MAX_RECORDED_US   (UINT16_MAX)
+
+static const char *series_names[NUM_SERIES] = {"i2c frame", "angle", "compare", "led write", "end to end"};
+
+static uint32_t stamps[LAT_NUM_STAGES];				/*Cycle stamps of the sample in progress*/
+static uint32_t stamped = 0;						/*Bit per stage stamped for the sample in progress*/
+static uint16_t samples[NUM_SERIES][LATENCY_SAMPLES];	/*Latencies in usec*/
+static int sample_count = 0;						/*Samples recorded, saturates at LATENCY_SAMPLES*/
+static int next_sample = 0;
+
+
+/*
+ * @brief Converts a cycle interval in to the usec stored in the sample table
+ *
+ * @return latency in usec, saturated to 16 bits
+ */
+static uint16_t to_recorded_us(uint32_t cycles)
+{
+	uint32_t us = timebase_cycles_to_us(cycles);
+	return (us > MAX_RECORDED_US) ? MAX_RECORDED_US : (uint16_t)us;
+}
+
+/*
+ * @brief Records the time a sample reached a stage
+ *
+ * @param stage the stage reached
+ * @return void
+ */
+void latency_stamp(latency_stage_t stage)
+{
+	uint32_t now = timebase_cycles();
+	crit_state_t masking_state = crit_enter(CRIT_LATENCY);	/*A fade bottom half may stamp in the middle*/
+	stamps[stage] = now;
+	if (stage == LAT_I2C_START)
+	{
+		stamped = 0;
+	}
+	stamped |= (1U << stage);
+
+	if ((stage != LAT_CNV_WRITTEN) || (stamped != ALL_STAGES))
+	{
+		crit_exit(CRIT_LATENCY, masking_state);
+		return;
+	}
+	for (int series = 0; series < END_TO_END; series++)		/*Stage n+1 measured from stage n*/
+	{
+		samples[series][next_sample] = to_recorded_us(stamps[series + 1] - stamps[series]);
+	}
+	samples[END_TO_END][next_sample] = to_recorded_us(stamps[LAT_CNV_WRITTEN] - stamps[LAT_I2C_START]);
+
+	next_sample = (next_sample + 1) % LATENCY_SAMPLES;
+	if (sample_count < LATENCY_SAMPLES)
+	{
+		sample_count++;
+	}
+	stamped = 0;
+	crit_exit(CRIT_LATENCY, masking_state);
+}
+
+/*
+ * @brief Sorts the latencies of one series in ascending order
+ *
+ * @param1 values latencies to sort
+ * @param2 count number of latencies
+ * @return void
+ */
+static void sort_samples(uint16_t *values, int count)
+{
+	for (int i = 1; i < count; i++)					/*Insertion sort, the table is small*/
+	{
+		uint16_t value = values[i];
+		int j = i - 1;
+		while ((j >= 0) && (values[j] > value))
+		{
+			values[j + 1] = values[j];
+			j--;
+		}
+		values[j + 1] = value;
+	}
+}
+
+/*
+ * @brief Prints p50/p99/max latency per stage and end to end, then clears the samples
+ *
+ * @return void
+ */
+void latency_report(void)
+{
+	uint16_t sorted[LATENCY_SAMPLES];
+	int count = sample_count;
+
+	if (count == 0)
+	{
+		printf("No samples, run the set command first\n\r");
+		return;
+	}
+	printf("Stage\t\tp50(us)\tp99(us)\tmax(us)\t(%d samples)\n\r", count);
+	for (int series = 0; series < NUM_SERIES; series++)
+	{
+		memcpy(sorted, samples[series], count * sizeof(uint16_t));
+		sort_samples(sorted, count);
+		printf("%s\t%u\t%u\t%u\n\r", series_names[series], (unsigned)sorted[count / 2],
+				(unsigned)sorted[(count * 99) / 100], (unsigned)sorted[count - 1]);
+	}
+	sample_count = 0;
+	next_sample = 0;
+}
+
+#else
+
+/*
+ * @brief Prints p50/p99/max latency per stage and end to end, then clears the samples
+ *
+ * @return void
+ */
+void latency_report(void)
+{
+	printf("Latency tracer is not enabled in this build\n\r");
+}
+
+#endif
@@ -0,0 +1,70 @@
+/**
+ * @file    latency.h
+ * @brief   This header file consists of the stage stamp macro and function prototypes of the
+ * 			tilt-to-LED latency tracer
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * Every sample of the set angle pipeline is stamped at each stage boundary. A sample is
+ * complete when the LED compare values are written after all the earlier stages; its
+ * per-stage and end-to-end latencies are kept for the last LATENCY_SAMPLES samples so the
+ * p50/p99/max can be reported. Enabled in Debug builds, define LATENCY_TRACE_ENABLE as 0
+ * or 1 to override.
+ */
+
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+#include <stdint.h>
+
+#if !defined(LATENCY_TRACE_ENABLE)
+#if defined(DEBUG)
+#define LATENCY_TRACE_ENABLE 1
+#else
+#define LATENCY_TRACE_ENABLE 0
+#endif
+#endif
+
+#define LATENCY_SAMPLES 100
+
+typedef enum
+{
+	LAT_I2C_START = 0,			/*Accelerometer frame read started*/
+	LAT_FRAME_RECEIVED,			/*Last byte of the frame read*/
+	LAT_ANGLE_COMPUTED,			/*Roll computed from the frame*/
+	LAT_COMPARE_DONE,			/*Guidance colour decided*/
+	LAT_CNV_WRITTEN,			/*TPM compare values written*/
+	LAT_NUM_STAGES
+} latency_stage_t;
+
+#if LATENCY_TRACE_ENABLE
+
+#define LAT_STAMP(stage)	latency_stamp(stage)
+
+/*
+ * @brief Records the time a sample reached a stage
+ *
+ * Stamping LAT_I2C_START starts a new sample, stamping LAT_CNV_WRITTEN completes it if
+ * every other stage was stamped in between. Safe from the PendSV bottom halves, where a
+ * fade writes its first compare values
+ *
+ * @param stage the stage reached
+ * @return void
+ */
+void latency_stamp(latency_stage_t stage);
+
+#else
+
+#define LAT_STAMP(stage)
+
+#endif
+
+/*
+ * @brief Prints p50/p99/max latency per stage and end to end, then clears the samples
+ *
+ * @return void
+ */
+void latency_report(void);
+
+#endif /* LATENCY_H_ */
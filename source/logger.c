@@ -0,0 +1,322 @@
+/**
+ * @file    logger.c
+ * @brief   This source file consists of function definitions of the accelerometer sample
+ * 			logger which records compressed frames to the reserved flash sectors
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "logger.h"
+#include "nvm.h"
+#include "accelerometer.h"
+#include "timer.h"
+#include "uart.h"
+#include "blog.h"
+
+#define LOG_END (NVM_LOG_ADDRESS + NVM_LOG_SIZE)
+#define HEADER_SIZE sizeof(log_chunk_header_t)
+#define MAX_FRAME_BYTES 9					/*Three varints of up to 3 bytes for 15 bit zigzag deltas*/
+#define ALIGN_UNIT(bytes) (((bytes) + NVM_PROGRAM_UNIT - 1) & ~(NVM_PROGRAM_UNIT - 1))
+
+static bool scanned = false;				/*Set once the end of the log is known*/
+static bool corrupt = false;				/*Something other than a chunk follows the log*/
+static bool recording = false;
+static uint32_t write_address;				/*Next free longword of the log area*/
+static uint32_t total_chunks = 0;
+static uint32_t total_frames = 0;
+static uint32_t session_frames = 0;
+static uint32_t session_overflows = 0;
+
+static uint32_t chunk[LOG_CHUNK_SIZE / sizeof(uint32_t)];	/*Chunk being filled, longword aligned for programming*/
+static log_chunk_header_t * const header = (log_chunk_header_t *)chunk;
+static uint32_t chunk_used = 0;				/*Bytes used in the chunk, 0 when empty*/
+static int16_t last_frame[3];
+static uint8_t next_flags = 0;				/*Flags of the next chunk started*/
+
+
+/*
+ * @brief Finds the end of the log and counts its chunks and frames, once
+ *
+ * @return void
+ */
+static void scan_log(void)
+{
+	if (scanned)
+	{
+		return;
+	}
+	scanned = true;
+	corrupt = false;
+	total_chunks = 0;
+	total_frames = 0;
+	write_address = NVM_LOG_ADDRESS;
+	while (write_address + HEADER_SIZE <= LOG_END)
+	{
+		const log_chunk_header_t *found = (const log_chunk_header_t *)write_address;
+		if (*(const uint32_t *)write_address == NVM_ERASED_WORD)
+		{
+			return;
+		}
+		uint32_t size = ALIGN_UNIT(HEADER_SIZE + found->length);
+		if ((found->magic != LOG_CHUNK_MAGIC) || (size > LOG_CHUNK_SIZE) ||
+			(write_address + size > LOG_END))
+		{
+			corrupt = true;					/*Not written by the logger, only an erase recovers*/
+			return;
+		}
+		total_chunks++;
+		total_frames += found->frames;
+		write_address += size;
+	}
+}
+
+/*
+ * @brief Appends a value as a zigzag varint
+ *
+ * @param1 out where to write
+ * @param2 value signed value
+ * @return bytes written
+ */
+static uint32_t put_varint(uint8_t *out, int32_t value)
+{
+	uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+	uint32_t bytes = 0;
+	while (zigzag >= 0x80)
+	{
+		out[bytes++] = (uint8_t)(zigzag | 0x80);
+		zigzag >>= 7;
+	}
+	out[bytes++] = (uint8_t)zigzag;
+	return bytes;
+}
+
+/*
+ * @brief Programs the chunk being filled to the end of the log
+ *
+ * @return true if programmed, false if the log is full
+ */
+static bool flush_chunk(void)
+{
+	if (chunk_used == 0)
+	{
+		return true;
+	}
+	uint32_t size = ALIGN_UNIT(chunk_used);
+	header->length = (uint16_t)(chunk_used - HEADER_SIZE);
+	memset((uint8_t *)chunk + chunk_used, 0xFF, size - chunk_used);
+	chunk_used = 0;
+	if ((write_address + size > LOG_END) || !nvm_program(write_address, chunk, size))
+	{
+		return false;
+	}
+	write_address += size;
+	total_chunks++;
+	total_frames += header->frames;
+	return true;
+}
+
+/*
+ * @brief Adds a frame to the chunk being filled, programming the chunk when it is full
+ *
+ * @param1 frame X, Y and Z in 14 bit counts
+ * @param2 timestamp_us arrival of the frame
+ * @return true if the frame was logged
+ */
+static bool append_frame(const int16_t frame[3], uint32_t timestamp_us)
+{
+	if (chunk_used != 0)
+	{
+		uint8_t encoded[MAX_FRAME_BYTES];
+		uint32_t bytes = 0;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			bytes += put_varint(&encoded[bytes], (int32_t)frame[axis] - last_frame[axis]);
+		}
+		if (chunk_used + bytes <= LOG_CHUNK_SIZE)
+		{
+			memcpy((uint8_t *)chunk + chunk_used, encoded, bytes);
+			chunk_used += bytes;
+			header->frames++;
+			memcpy(last_frame, frame, sizeof(last_frame));
+			return true;
+		}
+		if (!flush_chunk())
+		{
+			return false;
+		}
+	}
+	if (write_address + ALIGN_UNIT(HEADER_SIZE) > LOG_END)
+	{
+		return false;
+	}
+	header->magic = LOG_CHUNK_MAGIC;
+	header->timestamp_us = timestamp_us;
+	header->frames = 1;
+	header->period_us = MMA_ODR_PERIOD_US;
+	header->flags = next_flags;
+	header->reserved = 0xFF;
+	memcpy(header->first, frame, sizeof(header->first));
+	memcpy(last_frame, frame, sizeof(last_frame));
+	chunk_used = HEADER_SIZE;
+	next_flags = 0;
+	return true;
+}
+
+/*
+ * @brief Starts recording after the end of the log, appending to earlier sessions
+ *
+ * @return true if started, false if the log is full or needs an erase
+ */
+bool logger_start(void)
+{
+	scan_log();
+	if (corrupt || (write_address + LOG_CHUNK_SIZE > LOG_END))
+	{
+		return false;
+	}
+	chunk_used = 0;
+	next_flags = LOG_FLAG_SESSION_START;
+	session_frames = 0;
+	session_overflows = 0;
+	mma_fifo_enable(true);
+	recording = true;
+	return true;
+}
+
+/*
+ * @brief Drains the accelerometer FIFO in to the log, called every sample period
+ *
+ * Frames are timestamped back from the time of the read at the output data rate
+ *
+ * @return true while recording, false once the log is full
+ */
+bool logger_poll(void)
+{
+	int16_t frames[MMA_FIFO_SIZE][3];
+	bool overflow;
+
+	if (!recording)
+	{
+		return false;
+	}
+	int count = mma_read_fifo(frames, MMA_FIFO_SIZE, &overflow);
+	uint32_t now = timebase_us();
+	if (overflow)
+	{
+		session_overflows++;
+		BLOG1("logger: FIFO overflow after %lu frames", session_frames);
+		if (!flush_chunk())					/*The frame deltas and times do not carry over a gap*/
+		{
+			logger_stop();
+			return false;
+		}
+		next_flags |= LOG_FLAG_OVERFLOW;
+	}
+	for (int i = 0; i < count; i++)
+	{
+		if (!append_frame(frames[i], now - (uint32_t)(count - 1 - i) * MMA_ODR_PERIOD_US))
+		{
+			logger_stop();
+			return false;
+		}
+		session_frames++;
+	}
+	return true;
+}
+
+/*
+ * @brief Stops recording and programs the partly filled chunk
+ *
+ * @return void
+ */
+void logger_stop(void)
+{
+	if (!recording)
+	{
+		return;
+	}
+	recording = false;
+	flush_chunk();
+	mma_fifo_enable(false);
+}
+
+/*
+ * @brief Erases the log area one sector at a time
+ *
+ * Interrupts are unmasked between the sectors, so the systick and the UART keep up
+ *
+ * @return true if erased
+ */
+bool logger_erase(void)
+{
+	if (recording)
+	{
+		return false;
+	}
+	for (uint32_t sector = 0; sector < NVM_LOG_SECTORS; sector++)
+	{
+		if (!nvm_erase(NVM_LOG_ADDRESS + (sector * NVM_SECTOR_SIZE), NVM_SECTOR_SIZE))
+		{
+			scanned = false;
+			return false;
+		}
+	}
+	scanned = false;
+	scan_log();
+	return true;
+}
+
+/*
+ * @brief Sends the log as a text line with its size followed by the raw chunks
+ *
+ * The line is "LOG <bytes> <sum>", the sum is the 32 bit sum of the bytes which follow.
+ * The dump takes about 0.26 s per KB at 38400 baud
+ *
+ * @return void
+ */
+void logger_dump(void)
+{
+	scan_log();
+	uint32_t bytes = write_address - NVM_LOG_ADDRESS;
+	uint32_t sum = 0;
+	for (uint32_t i = 0; i < bytes; i++)
+	{
+		sum += ((const uint8_t *)NVM_LOG_ADDRESS)[i];
+	}
+	printf("LOG %lu %lu\n\r", (unsigned long)bytes, (unsigned long)sum);
+	uart0_write((const void *)NVM_LOG_ADDRESS, bytes);
+	printf("\n\rLOG END\n\r");
+}
+
+/*
+ * @brief Prints the used space, frame count and compression of the log
+ *
+ * @return void
+ */
+void logger_report(void)
+{
+	scan_log();
+	uint32_t used = write_address - NVM_LOG_ADDRESS;
+	printf("%s, %lu chunks, %lu frames, %lu of %u bytes used\n\r", recording ? "Recording" : "Stopped",
+			(unsigned long)total_chunks, (unsigned long)total_frames, (unsigned long)used, NVM_LOG_SIZE);
+	if (corrupt)
+	{
+		printf("The log area holds data not written by the logger, type log erase before logging\n\r");
+	}
+	if (total_frames != 0)
+	{
+		uint32_t centibytes = (used * 100) / total_frames;
+		uint32_t seconds_left = ((NVM_LOG_SIZE - used) * 100 / (centibytes ? centibytes : 1)) /
+				(1000000 / MMA_ODR_PERIOD_US);
+		printf("%lu.%02lu bytes per frame (6 raw), about %lu s of recording left\n\r",
+				(unsigned long)(centibytes / 100), (unsigned long)(centibytes % 100), (unsigned long)seconds_left);
+	}
+	if (recording)
+	{
+		printf("This session: %lu frames, %lu FIFO overflows\n\r",
+				(unsigned long)session_frames, (unsigned long)session_overflows);
+	}
+}
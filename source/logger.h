@@ -0,0 +1,89 @@
+/**
+ * @file    logger.h
+ * @brief   This header file consists of the chunk format and function prototypes of the
+ * 			accelerometer sample logger which records to the reserved flash sectors
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * While logging, the accelerometer buffers frames at its 800 Hz output data rate in its
+ * FIFO, which is drained every sample period. Frames are compressed in to a RAM chunk
+ * which is programmed to flash when full, the FIFO covers the frames arriving meanwhile.
+ * The chunk is programmed a longword at a time with interrupts unmasked in between, so
+ * the systick, the timebase and the UART receiver keep up while it is written. The log
+ * area is erased in advance, so no sector is erased while logging.
+ *
+ * A chunk is a log_chunk_header_t with the first frame, followed by every later frame as
+ * the change of X, Y and Z from the frame before, each zigzag encoded and written as a
+ * varint: 7 bits per byte, least significant first, the top bit set on all but the last
+ * byte. A still board costs 3 bytes per frame instead of 6. Chunks are padded with 0xFF
+ * to a longword, an erased longword ends the log.
+ */
+
+#ifndef LOGGER_H_
+#define LOGGER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LOG_CHUNK_MAGIC 0x474C				/*"LG"*/
+#define LOG_CHUNK_SIZE 256					/*Bytes programmed at once, header included*/
+#define LOG_FLAG_SESSION_START 0x01			/*First chunk after log start*/
+#define LOG_FLAG_OVERFLOW 0x02				/*Frames were lost before the first frame of the chunk*/
+
+typedef struct
+{
+	uint16_t magic;
+	uint16_t length;						/*Bytes of compressed frames after the header*/
+	uint32_t timestamp_us;					/*Arrival of the first frame, timebase_us()*/
+	uint16_t frames;						/*Frames in the chunk, the first one included*/
+	uint16_t period_us;						/*Between frames*/
+	uint8_t flags;
+	uint8_t reserved;
+	int16_t first[3];						/*X, Y and Z of the first frame in 14 bit counts*/
+} log_chunk_header_t;
+
+
+/*
+ * @brief Starts recording after the end of the log, appending to earlier sessions
+ *
+ * @return true if started, false if the log is full or needs an erase
+ */
+bool logger_start(void);
+
+/*
+ * @brief Drains the accelerometer FIFO in to the log, called every sample period
+ *
+ * @return true while recording, false once the log is full
+ */
+bool logger_poll(void);
+
+/*
+ * @brief Stops recording and programs the partly filled chunk
+ *
+ * @return void
+ */
+void logger_stop(void);
+
+/*
+ * @brief Erases the log area one sector at a time
+ *
+ * @return true if erased
+ */
+bool logger_erase(void);
+
+/*
+ * @brief Sends the log as a text line with its size followed by the raw chunks
+ *
+ * @return void
+ */
+void logger_dump(void);
+
+/*
+ * @brief Prints the used space, frame count and compression of the log
+ *
+ * @return void
+ */
+void logger_report(void);
+
+#endif /* LOGGER_H_ */
@@ -0,0 +1,117 @@
+/**
+ * @file    mem.c
+ * @brief   This source file consists of function definitions of the SRAM budget monitor,
+ * 			which paints the stack at startup to find its high-water mark and breaks down
+ * 			the static RAM use
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * The stack is painted down to the end of the heap, through the unallocated RAM between
+ * them, so a stack which grew past _vStackBase leaves a mark below it and is reported as
+ * an overflow rather than as 100% used. The per-module breakdown of the data and bss
+ * sections is generated on the host from the linker map, by tools/ramusage.py.
+ */
+
+#include <stdio.h>
+#include "MKL25Z4.h"
+#include "mem.h"
+#include "trace.h"
+
+extern unsigned int __data_section_table;		/*Load address, run address, length*/
+extern unsigned int __data_section_table_end;
+extern unsigned int __bss_section_table;		/*Address, length*/
+extern unsigned int __bss_section_table_end;
+extern unsigned int _pvHeapStart;
+extern unsigned int _pvHeapLimit;
+extern unsigned int _vStackBase;
+extern unsigned int _vStackTop;
+
+
+/*
+ * @brief Fills the unused part of the stack, and the unallocated RAM below it, with
+ * 		  MEM_PAINT, called first thing in main()
+ *
+ * Interrupts taken while painting only overwrite paint below the stack pointer, which
+ * then correctly counts as used
+ *
+ * @return void
+ */
+void mem_paint_stack(void)
+{
+	unsigned int *word = &_pvHeapLimit;
+	unsigned int *limit = (unsigned int *)((__get_MSP() - MEM_PAINT_MARGIN) & ~3U);
+	while (word < limit)
+	{
+		*word++ = MEM_PAINT;
+	}
+}
+
+/*
+ * @brief Deepest the stack has been since it was painted
+ *
+ * @return bytes of stack used at the high-water mark, more than the stack size if it
+ * 		   overflowed in to the unallocated RAM
+ */
+uint32_t mem_stack_high_water(void)
+{
+	unsigned int *word = &_pvHeapLimit;
+	while ((word < &_vStackTop) && (*word == MEM_PAINT))
+	{
+		word++;
+	}
+	return (uint32_t)&_vStackTop - (uint32_t)word;
+}
+
+/*
+ * @brief Adds up the lengths of the data or bss section table
+ *
+ * @param1 entry first entry of the table
+ * @param2 end end of the table
+ * @param3 words words per entry, the length is the last one
+ * @return bytes in all the sections
+ */
+static uint32_t section_bytes(const unsigned int *entry, const unsigned int *end, uint32_t words)
+{
+	uint32_t bytes = 0;
+	for (; entry < end; entry += words)
+	{
+		bytes += entry[words - 1];
+	}
+	return bytes;
+}
+
+/*
+ * @brief Prints the SRAM budget: sections, heap, stack high-water and unallocated RAM
+ *
+ * @return void
+ */
+void mem_report(void)
+{
+	uint32_t data = section_bytes(&__data_section_table, &__data_section_table_end, 3);
+	uint32_t bss = section_bytes(&__bss_section_table, &__bss_section_table_end, 2);
+	uint32_t heap = (uint32_t)&_pvHeapLimit - (uint32_t)&_pvHeapStart;
+	uint32_t stack = (uint32_t)&_vStackTop - (uint32_t)&_vStackBase;
+	uint32_t used = mem_stack_high_water();
+	uint32_t gap = (uint32_t)&_vStackBase - (uint32_t)&_pvHeapLimit;
+
+	printf("SRAM %d bytes at 0x%08X\n\r", MEM_SRAM_SIZE, MEM_SRAM_START);
+	printf("  data\t\t%lu (initialised variables and RAM functions)\n\r", (unsigned long)data);
+	printf("  bss\t\t%lu\n\r", (unsigned long)bss);
+	printf("  heap\t\t%lu reserved\n\r", (unsigned long)heap);
+	if (used > stack)
+	{
+		printf("  stack\t\t%lu, OVERFLOWED by %lu in to the unallocated RAM%s\n\r", (unsigned long)stack,
+				(unsigned long)(used - stack), (used >= stack + gap) ? ", possibly in to the heap" : "");
+	}
+	else
+	{
+		printf("  stack\t\t%lu, high-water %lu (%lu%%), %lu never used\n\r", (unsigned long)stack,
+				(unsigned long)used, (unsigned long)((used * 100) / stack), (unsigned long)(stack - used));
+	}
+	printf("  unallocated\t%lu\n\r", (unsigned long)gap);
+#if TRACE_ENABLE
+	printf("  MTB trace\t%d (own section, outside data and bss)\n\r", __MTB_BUFFER_SIZE);
+#endif
+	printf("Per module: tools/ramusage.py on the map file of this build\n\r");
+}
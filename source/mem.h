@@ -0,0 +1,49 @@
+/**
+ * @file    mem.h
+ * @brief   This header file consists of function prototypes of the SRAM budget monitor,
+ * 			which paints the stack at startup to find its high-water mark and breaks down
+ * 			the static RAM use
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * The section and stack limits come from the symbols of the MCUXpresso managed linker
+ * script: the data and bss section tables used by the startup code, _pvHeapStart,
+ * _pvHeapLimit, _vStackBase and _vStackTop.
+ */
+
+#ifndef MEM_H_
+#define MEM_H_
+
+#include <stdint.h>
+
+#define MEM_SRAM_START 0x1FFFF000			/*SRAM_L and SRAM_U, contiguous*/
+#define MEM_SRAM_SIZE (16 * 1024)
+#define MEM_PAINT 0xC5C5C5C5				/*Pattern the unused stack is filled with*/
+#define MEM_PAINT_MARGIN 64					/*Bytes below the stack pointer left unpainted*/
+
+/*
+ * @brief Fills the unused part of the stack, and the unallocated RAM below it, with
+ * 		  MEM_PAINT, called first thing in main()
+ *
+ * @return void
+ */
+void mem_paint_stack(void);
+
+/*
+ * @brief Deepest the stack has been since it was painted
+ *
+ * @return bytes of stack used at the high-water mark, more than the stack size if it
+ * 		   overflowed in to the unallocated RAM
+ */
+uint32_t mem_stack_high_water(void);
+
+/*
+ * @brief Prints the SRAM budget: sections, heap, stack high-water and unallocated RAM
+ *
+ * @return void
+ */
+void mem_report(void);
+
+
+#endif /* MEM_H_ */
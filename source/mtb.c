@@ -55,10 +55,8 @@
 #if !defined (__MTB_DISABLE)
 
   // Allow for MTB buffer size being set by define set via command line
-  // Otherwise provide small default buffer
-  #if !defined (__MTB_BUFFER_SIZE)
-    #define __MTB_BUFFER_SIZE 128
-  #endif
+  // Otherwise the default of trace.h, which uses the buffer, applies
+  #include "trace.h"
   
   // Check that buffer size requested is >0 bytes in size
   #if (__MTB_BUFFER_SIZE > 0)
@@ -0,0 +1,97 @@
+/**
+ * @file    nvm.c
+ * @brief   This source file consists of function definitions to erase and program the
+ * 			reserved flash sectors through the flash driver
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) KL25 Sub-Family Reference Manual, Chapter 27 Flash Memory Module (FTFA)
+ */
+
+#include <string.h>
+#include "nvm.h"
+#include "critical.h"
+#include "MKL25Z4.h"
+
+extern unsigned int __top_PROGRAM_FLASH;		/*End of the flash the image is linked in to*/
+
+static flash_config_t flash_driver;
+static bool flash_ready = false;
+
+
+/*
+ * @brief Initializes the flash driver once
+ *
+ * @return true if the driver is ready
+ */
+static bool flash_init(void)
+{
+	if (!flash_ready)
+	{
+		memset(&flash_driver, 0, sizeof(flash_driver));
+		flash_ready = (FLASH_Init(&flash_driver) == kStatus_FLASH_Success);
+#if FLASH_DRIVER_IS_FLASH_RESIDENT
+		if (flash_ready)					/*The command launch must not run from the flash it waits on*/
+		{
+			flash_ready = (FLASH_PrepareExecuteInRamFunctions(&flash_driver) == kStatus_FLASH_Success);
+		}
+#endif
+	}
+	return flash_ready;
+}
+
+/*
+ * @brief Checks that an operation stays clear of the linked image
+ *
+ * @param address start of the operation
+ * @return true if the address is above the PROGRAM_FLASH region
+ */
+static bool outside_image(uint32_t address)
+{
+	return address >= (uint32_t)&__top_PROGRAM_FLASH;
+}
+
+/*
+ * @brief Erases whole sectors
+ *
+ * @param1 address start of the first sector
+ * @param2 size bytes to erase, a multiple of NVM_SECTOR_SIZE
+ * @return true if erased, false on a driver error or an address inside the image
+ */
+bool nvm_erase(uint32_t address, uint32_t size)
+{
+	if (!outside_image(address) || !flash_init())
+	{
+		return false;
+	}
+	crit_state_t masking_state = crit_enter(CRIT_FLASH);	/*No flash access while the only flash block is busy*/
+	status_t status = FLASH_Erase(&flash_driver, address, size, kFLASH_ApiEraseKey);
+	crit_exit(CRIT_FLASH, masking_state);
+	return status == kStatus_FLASH_Success;
+}
+
+/*
+ * @brief Programs erased flash and verifies it
+ *
+ * @param1 address destination, aligned to NVM_PROGRAM_UNIT
+ * @param2 data source in RAM
+ * @param3 size bytes to program, a multiple of NVM_PROGRAM_UNIT
+ * @return true if programmed and verified, false on an error or an address inside the image
+ */
+bool nvm_program(uint32_t address, const void *data, uint32_t size)
+{
+	if (!outside_image(address) || !flash_init())
+	{
+		return false;
+	}
+	const uint8_t *source = data;
+	status_t status = kStatus_FLASH_Success;
+	for (uint32_t offset = 0; (offset < size) && (status == kStatus_FLASH_Success); offset += NVM_PROGRAM_UNIT)
+	{
+		crit_state_t masking_state = crit_enter(CRIT_FLASH);	/*One unit at a time, interrupts are served in between*/
+		status = FLASH_Program(&flash_driver, address + offset, (uint32_t *)(source + offset), NVM_PROGRAM_UNIT);
+		crit_exit(CRIT_FLASH, masking_state);
+	}
+	return (status == kStatus_FLASH_Success) && (memcmp((const void *)address, data, size) == 0);
+}
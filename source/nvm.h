@@ -0,0 +1,59 @@
+/**
+ * @file    nvm.h
+ * @brief   This header file consists of the layout of the reserved flash sectors and the
+ * 			function prototypes to erase and program them
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * The reserved sectors are at the end of the program flash, the image must not grow in
+ * to them: the PROGRAM_FLASH region of the project's memory configuration ends below
+ * them, so the link fails before it does, and nvm_erase() and nvm_program() refuse any
+ * address inside that region.
+ *
+ * The KL25Z has a single flash block, so the CPU cannot fetch from flash while it is
+ * erased or programmed, and interrupts are masked while the controller is busy. An erase
+ * masks them for the whole sector, so erases are left to commands and compactions.
+ * Programming masks them for one longword at a time, 65 us typical and 145 us worst case,
+ * so a log chunk written while recording neither drops systicks nor received characters.
+ */
+
+#ifndef NVM_H_
+#define NVM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fsl_flash.h"
+
+#define NVM_SECTOR_SIZE   FSL_FEATURE_FLASH_PFLASH_BLOCK_SECTOR_SIZE
+#define NVM_PROGRAM_UNIT  FSL_FEATURE_FLASH_PFLASH_BLOCK_WRITE_UNIT_SIZE	/*Longword*/
+#define NVM_ERASED_WORD   0xFFFFFFFFu
+
+#define NVM_KV_SECTORS    2				/*Key/value store, written alternately*/
+#define NVM_KV_ADDRESS    (FSL_FEATURE_FLASH_PFLASH_BLOCK_SIZE - (NVM_KV_SECTORS * NVM_SECTOR_SIZE))
+
+#define NVM_LOG_SECTORS   32				/*Sample log, right below the key/value store, PROGRAM_FLASH ends at its start*/
+#define NVM_LOG_SIZE      (NVM_LOG_SECTORS * NVM_SECTOR_SIZE)
+#define NVM_LOG_ADDRESS   (NVM_KV_ADDRESS - NVM_LOG_SIZE)
+
+
+/*
+ * @brief Erases whole sectors
+ *
+ * @param1 address start of the first sector
+ * @param2 size bytes to erase, a multiple of NVM_SECTOR_SIZE
+ * @return true if erased, false on a driver error or an address inside the image
+ */
+bool nvm_erase(uint32_t address, uint32_t size);
+
+/*
+ * @brief Programs erased flash and verifies it
+ *
+ * @param1 address destination, aligned to NVM_PROGRAM_UNIT
+ * @param2 data source in RAM
+ * @param3 size bytes to program, a multiple of NVM_PROGRAM_UNIT
+ * @return true if programmed and verified, false on an error or an address inside the image
+ */
+bool nvm_program(uint32_t address, const void *data, uint32_t size);
+
+#endif /* NVM_H_ */
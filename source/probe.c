@@ -0,0 +1,161 @@
+/**
+ * @file    probe.c
+ * @brief   This source file consists of function definitions of the probes used to time hot
+ * 			paths externally, on spare GPIO pins or in to a VCD file in a host build
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ */
+
+#include "probe.h"
+
+#if PROBE_ENABLE && defined(PROBE_HOST)
+
+#include <stdio.h>
+#include <time.h>
+
+#define PROBE_MAX_PIN 32
+
+static const char *const probe_names[PROBE_MAX_PIN] =
+{
+	[PROBE_ANGLE] = "angle",
+	[PROBE_UART_ISR] = "uart_isr",
+	[PROBE_GUIDANCE] = "guidance",
+	[PROBE_I2C_READ] = "i2c_read",
+};
+
+static FILE *vcd = NULL;
+static struct timespec opened;
+static unsigned long long last_time = ~0ULL;
+
+
+/*
+ * @brief Nanoseconds since the VCD file was created
+ *
+ * @return time stamp
+ */
+static unsigned long long elapsed_ns(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((unsigned long long)(now.tv_sec - opened.tv_sec) * 1000000000ULL) + now.tv_nsec - opened.tv_nsec;
+}
+
+/*
+ * @brief Creates the VCD file the probes are recorded in, times are counted from here
+ *
+ * Every probe is a one bit wire named after its region, identified by the character
+ * '!' plus its pin number
+ *
+ * @param path file name
+ * @return true if the file was created
+ */
+bool probe_host_open(const char *path)
+{
+	vcd = fopen(path, "w");
+	if (vcd == NULL)
+	{
+		return false;
+	}
+	fprintf(vcd, "$timescale 1ns $end\n$scope module probes $end\n");
+	for (int pin = 0; pin < PROBE_MAX_PIN; pin++)
+	{
+		if (probe_names[pin] != NULL)
+		{
+			fprintf(vcd, "$var wire 1 %c %s $end\n", '!' + pin, probe_names[pin]);
+		}
+	}
+	fprintf(vcd, "$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\n");
+	for (int pin = 0; pin < PROBE_MAX_PIN; pin++)
+	{
+		if (probe_names[pin] != NULL)
+		{
+			fprintf(vcd, "0%c\n", '!' + pin);
+		}
+	}
+	fprintf(vcd, "$end\n");
+	last_time = 0;
+	clock_gettime(CLOCK_MONOTONIC, &opened);
+	return true;
+}
+
+/*
+ * @brief Records an edge of a probe in the VCD file
+ *
+ * @param1 probe the probe
+ * @param2 level new level of the probe
+ * @return void
+ */
+void probe_host_set(probe_t probe, bool level)
+{
+	if (vcd == NULL)
+	{
+		return;
+	}
+	unsigned long long now = elapsed_ns();
+	if (now <= last_time)
+	{
+		now = last_time + 1;					/*Keeps every edge visible at a 1 ns resolution*/
+	}
+	fprintf(vcd, "#%llu\n%c%c\n", now, level ? '1' : '0', '!' + (int)probe);
+	last_time = now;
+}
+
+/*
+ * @brief Closes the VCD file
+ *
+ * @return void
+ */
+void probe_host_close(void)
+{
+	if (vcd != NULL)
+	{
+		fclose(vcd);
+		vcd = NULL;
+	}
+}
+
+/*
+ * @brief Configures the probe pins as outputs, nothing to do on the host
+ *
+ * @return void
+ */
+void probe_init(void)
+{
+}
+
+#elif PROBE_ENABLE
+
+#include "MKL25Z4.h"
+
+/*
+ * @brief Configures the probe pins as outputs, driven low
+ *
+ * @return void
+ */
+void probe_init(void)
+{
+	SIM->SCGC5 |= SIM_SCGC5_PORTC_MASK;
+	for (uint32_t pin = 0; pin < 32; pin++)
+	{
+		if (PROBE_PINS & (1U << pin))
+		{
+			PORTC->PCR[pin] = PORT_PCR_MUX(1);		/*GPIO*/
+		}
+	}
+	FPTC->PCOR = PROBE_PINS;
+	FPTC->PDDR |= PROBE_PINS;
+}
+
+#else
+
+/*
+ * @brief Configures the probe pins as outputs, probes are not enabled in this build
+ *
+ * @return void
+ */
+void probe_init(void)
+{
+}
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * @file    probe.h
+ * @brief   This header file consists of the probe macros and function prototypes used to time
+ * 			hot paths externally, by driving spare GPIO pins for a logic analyzer
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * PROBE_HIGH(probe) and PROBE_LOW(probe) around a region make its pin high while the region
+ * runs. The pins are written through the single cycle FGPIO alias of port C, a constant
+ * probe compiles to one store, so the probe barely changes the timing it shows. Every probe
+ * pin is on the J1 header of the FRDM-KL25Z and no other function uses them. Around a whole
+ * interrupt handler PROBE_ISR_HIGH() and PROBE_ISR_LOW() only drive the pin in handler mode,
+ * so a benchmark calling the handler from thread mode does not show as an interrupt.
+ *
+ * Off by default as the pins are driven, define PROBE_ENABLE as 1 to build them in. Built
+ * with PROBE_HOST defined, for code compiled on the host, the probes record their edges
+ * in to a VCD file instead, see tools/probevcd.c
+ */
+
+#ifndef PROBE_H_
+#define PROBE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#if !defined(PROBE_ENABLE)
+#if defined(PROBE_HOST)
+#define PROBE_ENABLE 1
+#else
+#define PROBE_ENABLE 0
+#endif
+#endif
+
+typedef enum						/*Value is the port C pin number*/
+{
+	PROBE_ANGLE = 0,				/*PTC0, J1 pin 3: roll computed from a frame*/
+	PROBE_UART_ISR = 3,				/*PTC3, J1 pin 5: UART0 interrupt handler*/
+	PROBE_GUIDANCE = 4,				/*PTC4, J1 pin 7: guidance colour lookup*/
+	PROBE_I2C_READ = 7				/*PTC7, J1 pin 1: accelerometer frame read*/
+} probe_t;
+
+#define PROBE_PINS ((1U << PROBE_ANGLE) | (1U << PROBE_UART_ISR) | (1U << PROBE_GUIDANCE) | (1U << PROBE_I2C_READ))
+
+#if PROBE_ENABLE && defined(PROBE_HOST)
+
+#define PROBE_HIGH(probe)	probe_host_set((probe), true)
+#define PROBE_LOW(probe)	probe_host_set((probe), false)
+#define PROBE_ISR_HIGH(probe)	PROBE_HIGH(probe)
+#define PROBE_ISR_LOW(probe)	PROBE_LOW(probe)
+
+/*
+ * @brief Creates the VCD file the probes are recorded in, times are counted from here
+ *
+ * @param path file name
+ * @return true if the file was created
+ */
+bool probe_host_open(const char *path);
+
+/*
+ * @brief Records an edge of a probe in the VCD file
+ *
+ * @param1 probe the probe
+ * @param2 level new level of the probe
+ * @return void
+ */
+void probe_host_set(probe_t probe, bool level);
+
+/*
+ * @brief Closes the VCD file
+ *
+ * @return void
+ */
+void probe_host_close(void);
+
+#elif PROBE_ENABLE
+
+#include "MKL25Z4.h"
+
+#define PROBE_HIGH(probe)	(FPTC->PSOR = (1U << (probe)))
+#define PROBE_LOW(probe)	(FPTC->PCOR = (1U << (probe)))
+#define PROBE_ISR_HIGH(probe)	do { if (__get_IPSR() != 0U) { PROBE_HIGH(probe); } } while (0)
+#define PROBE_ISR_LOW(probe)	do { if (__get_IPSR() != 0U) { PROBE_LOW(probe); } } while (0)
+
+#else
+
+#define PROBE_HIGH(probe)	((void)0)
+#define PROBE_LOW(probe)	((void)0)
+#define PROBE_ISR_HIGH(probe)	((void)0)
+#define PROBE_ISR_LOW(probe)	((void)0)
+
+#endif
+
+/*
+ * @brief Configures the probe pins as outputs, driven low
+ *
+ * @return void
+ */
+void probe_init(void);
+
+
+#endif /* PROBE_H_ */
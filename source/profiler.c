@@ -0,0 +1,144 @@
+/**
+ * @file    profiler.c
+ * @brief   This source file consists of function definitions of the hot-path profiler
+ * 			which records per-probe cycle statistics
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "profiler.h"
+
+#if PROFILER_ENABLE
+
+#define CALIBRATION_RUNS 8
+
+typedef struct
+{
+	uint32_t calls;
+	uint32_t min;
+	uint32_t max;
+	uint64_t total;
+	uint32_t histogram[PROF_HISTOGRAM_BUCKETS];
+} prof_entry_t;
+
+static const char *probe_names[PROF_NUM_PROBES] = {"get_roll", "atan2", "update_led_colour",
+												   "echo", "__sys_write", "process_command"};
+
+static prof_entry_t prof_table[PROF_NUM_PROBES];
+static uint32_t overhead = 0;				/*Cycles taken by an empty PROF_BEGIN/PROF_END pair*/
+static int calibrated = 0;
+
+
+/*
+ * @brief Measures the cost of an empty probe so it can be taken off every measurement
+ *
+ * @return void
+ */
+static void calibrate_overhead(void)
+{
+	uint32_t minimum = UINT32_MAX;
+	for (int i = 0; i < CALIBRATION_RUNS; i++)
+	{
+		uint32_t start = timebase_cycles();
+		uint32_t cycles = timebase_cycles() - start;
+		if (cycles < minimum)
+		{
+			minimum = cycles;
+		}
+	}
+	overhead = minimum;
+	calibrated = 1;
+}
+
+/*
+ * @brief Adds one measurement to a probe, called by PROF_END()
+ *
+ * @param1 probe the probe
+ * @param2 cycles cycles taken by the region including the measurement overhead
+ * @return void
+ */
+void profiler_record(prof_probe_t probe, uint32_t cycles)
+{
+	prof_entry_t *entry = &prof_table[probe];
+	int bucket = 0;
+
+	if (!calibrated)
+	{
+		calibrate_overhead();
+	}
+	cycles = (cycles > overhead) ? (cycles - overhead) : 0;
+
+	if ((entry->calls == 0) || (cycles < entry->min))
+	{
+		entry->min = cycles;
+	}
+	if (cycles > entry->max)
+	{
+		entry->max = cycles;
+	}
+	entry->calls++;
+	entry->total += cycles;
+
+	if (cycles != 0)
+	{
+		bucket = 31 - __builtin_clz(cycles);				/*floor(log2(cycles))*/
+	}
+	if (bucket >= PROF_HISTOGRAM_BUCKETS)
+	{
+		bucket = PROF_HISTOGRAM_BUCKETS - 1;
+	}
+	entry->histogram[bucket]++;
+}
+
+/*
+ * @brief Prints the statistics of every probe which was hit and clears the table
+ *
+ * @return void
+ */
+void profiler_report(void)
+{
+	prof_entry_t snapshot[PROF_NUM_PROBES];
+
+	memcpy(snapshot, prof_table, sizeof(prof_table));	/*The printing below is profiled too*/
+	memset(prof_table, 0, sizeof(prof_table));
+
+	printf("Probe\t\t\tCalls\tMin\tMax\tMean (cycles, %lu per ms)\n\r",
+			(unsigned long)timebase_cycles_per_tick());
+	for (int probe = 0; probe < PROF_NUM_PROBES; probe++)
+	{
+		prof_entry_t *entry = &snapshot[probe];
+		if (entry->calls == 0)
+		{
+			continue;
+		}
+		printf("%s\t\t%lu\t%lu\t%lu\t%lu\n\r", probe_names[probe], (unsigned long)entry->calls,
+				(unsigned long)entry->min, (unsigned long)entry->max,
+				(unsigned long)(entry->total / entry->calls));
+		printf("  log2 histogram:");
+		for (int bucket = 0; bucket < PROF_HISTOGRAM_BUCKETS; bucket++)
+		{
+			if (entry->histogram[bucket] != 0)
+			{
+				printf(" [%lu+]=%lu", 1UL << bucket, (unsigned long)entry->histogram[bucket]);
+			}
+		}
+		printf("\n\r");
+	}
+}
+
+#else
+
+/*
+ * @brief Prints the statistics of every probe which was hit and clears the table
+ *
+ * @return void
+ */
+void profiler_report(void)
+{
+	printf("Profiler is not enabled in this build\n\r");
+}
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * @file    profiler.h
+ * @brief   This header file consists of the instrumentation macros and function prototypes
+ * 			of the hot-path profiler which records per-probe cycle statistics
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * Wrap a region with PROF_BEGIN(probe) and PROF_END(probe) in the same scope. The probe
+ * records the call count, min/max/mean cycles and a log2 histogram of the cycles taken.
+ * The profiler is enabled in Debug builds and compiles out completely in Release builds,
+ * define PROFILER_ENABLE as 0 or 1 to override.
+ */
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <stdint.h>
+
+#if !defined(PROFILER_ENABLE)
+#if defined(DEBUG)
+#define PROFILER_ENABLE 1
+#else
+#define PROFILER_ENABLE 0
+#endif
+#endif
+
+#define PROF_HISTOGRAM_BUCKETS 16	/*Bucket n counts calls taking 2^n to 2^(n+1)-1 cycles, the last one everything above*/
+
+typedef enum
+{
+	PROF_GET_ROLL = 0,
+	PROF_ATAN2,
+	PROF_UPDATE_LED,
+	PROF_ECHO,
+	PROF_SYS_WRITE,
+	PROF_PROCESS_COMMAND,
+	PROF_NUM_PROBES
+} prof_probe_t;
+
+#if PROFILER_ENABLE
+
+#include "timer.h"
+
+#define PROF_BEGIN(probe)	uint32_t prof_start_##probe = timebase_cycles()
+#define PROF_END(probe)		profiler_record((probe), timebase_cycles() - prof_start_##probe)
+
+/*
+ * @brief Adds one measurement to a probe, called by PROF_END()
+ *
+ * Not reentrant, probes must not be used from interrupt handlers
+ *
+ * @param1 probe the probe
+ * @param2 cycles cycles taken by the region including the measurement overhead
+ * @return void
+ */
+void profiler_record(prof_probe_t probe, uint32_t cycles);
+
+#else
+
+#define PROF_BEGIN(probe)
+#define PROF_END(probe)
+
+#endif
+
+/*
+ * @brief Prints the statistics of every probe which was hit and clears the table
+ *
+ * @return void
+ */
+void profiler_report(void);
+
+#endif /* PROFILER_H_ */
@@ -16,6 +16,7 @@
 #include<stdint.h>
 #include<stdbool.h>
 #include "queue.h"
+#include "ramfunc.h"
 #define ZERO (0)
 
 #define NOT_SET (0)
@@ -30,7 +31,7 @@ Q_T RxQ={{0},0,0,0,0,false,true};
 * @parameter Rx/Tx buffer instance
 * @return 1 if queue is empty or 0 if queue is not empty
 */
-bool Q_Empty(Q_T *cbfifo)
+RAMFUNC bool Q_Empty(Q_T *cbfifo)
 {
 	if((cbfifo->rear==cbfifo->front) && (cbfifo->queueFull == NOT_SET) /*Rear==Front is occuring for both, queue full*/
 		&& (cbfifo->queueEmpty == SET)) 		    /*and empty, differentiating them using flags*/
@@ -50,7 +51,7 @@ bool Q_Empty(Q_T *cbfifo)
 * @parameter Rx/Tx buffer instance
 * @return 1 if queue is full or 0 if queue is not full
 */
-bool Q_Full(Q_T *cbfifo)
+RAMFUNC bool Q_Full(Q_T *cbfifo)
 {
 	if((cbfifo->queueFull == SET) && (cbfifo->rear == cbfifo->front))/*Rear==Front is occuring for both, queue full*/
 	{									/*and empty, differentiating them using flags	*/
@@ -91,7 +92,7 @@ int Q_Size(Q_T *cbfifo)
  *   The number of bytes actually enqueued, which could be 0. In case
  * of an error, returns -1.
  */
-int Q_Enqueue(Q_T *cbfifo,void *buf, size_t nbyte)
+RAMFUNC int Q_Enqueue(Q_T *cbfifo,void *buf, size_t nbyte)
 {
 	int i=0; /*local variable to increment till n byte*/
 	uint8_t *tempdata= (uint8_t *)buf;
@@ -145,7 +146,7 @@ int Q_Enqueue(Q_T *cbfifo,void *buf, size_t nbyte)
  * any number of bytes will result in a return of 0 from
  * cbfifo_dequeue.
  */
-uint8_t Q_Dequeue(Q_T *cbfifo, void *buf, size_t nbyte)
+RAMFUNC uint8_t Q_Dequeue(Q_T *cbfifo, void *buf, size_t nbyte)
 {
 	int i=0; /*local variable to increment till n byte */
 	int j=0; /*local variable to increment buffer index
@@ -0,0 +1,248 @@
+/**
+ * @file    ramfunc.c
+ * @brief   This source file consists of the list of RAM-resident functions and the report
+ * 			of their RAM cost and cycle savings
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "MKL25Z4.h"
+#include "ramfunc.h"
+#include "timer.h"
+#include "queue.h"
+#include "uart.h"
+#include "i2c.h"
+#include "accelerometer.h"
+#include "guidance.h"
+#include "critical.h"
+#include "irqstat.h"
+
+#define SRAM_START 0x1FFFF000U			/*SRAM_L*/
+#define SRAM_END   0x20003000U			/*End of SRAM_U*/
+#define BENCH_BYTES 8
+
+typedef void (*bench_t)(uintptr_t fn);
+
+typedef struct
+{
+	const char *name;
+	void (*fn)(void);					/*RAM-resident function*/
+	uint32_t data_bytes;				/*RAMDATA tables used by the function*/
+	bench_t bench;						/*Calls the copy at fn the way the sample path does, NULL if not benchmarked*/
+} ramfunc_entry_t;
+
+/*Load address, execution address and length of every initialized data section, made by the linker*/
+extern unsigned int __data_section_table;
+extern unsigned int __data_section_table_end;
+
+/*
+ * Placed right after the last .ramfunc section: the managed linker script puts
+ * CodeQuickAccess between .ramfunc and the rest of .data
+ */
+__attribute__((used, section("CodeQuickAccess"))) static uint32_t ramfunc_end;
+
+static Q_T bench_queue;
+static uint8_t bench_data[BENCH_BYTES];
+
+void UART0_IRQHandler(void);
+
+
+/*
+ * @brief Enqueues and dequeues a burst of bytes as the UART does for a short line
+ *
+ * @param fn copy of Q_Enqueue to call
+ * @return void
+ */
+static void bench_enqueue(uintptr_t fn)
+{
+	((int (*)(Q_T *, void *, size_t))fn)(&bench_queue, bench_data, BENCH_BYTES);
+	Q_Dequeue(&bench_queue, bench_data, BENCH_BYTES);
+}
+
+/*
+ * @brief Enqueues and dequeues a burst of bytes as the UART does for a short line
+ *
+ * @param fn copy of Q_Dequeue to call
+ * @return void
+ */
+static void bench_dequeue(uintptr_t fn)
+{
+	Q_Enqueue(&bench_queue, bench_data, BENCH_BYTES);
+	((uint8_t (*)(Q_T *, void *, size_t))fn)(&bench_queue, bench_data, BENCH_BYTES);
+}
+
+/*
+ * @brief Runs the UART interrupt handler once, with nothing to receive it only polls the flags
+ *
+ * UART0 is disabled in the NVIC around the call, so the live handler can never preempt the
+ * copy in the middle of its queue operations, which are not reentrant; a character which
+ * arrives meanwhile is served by the copy as the handler would, or right after the call.
+ * The two NVIC writes are timed in the flash and the SRAM runs alike.
+ *
+ * @param fn copy of UART0_IRQHandler to call
+ * @return void
+ */
+static void bench_uart_isr(uintptr_t fn)
+{
+	NVIC_DisableIRQ(UART0_IRQn);
+	((void (*)(void))fn)();
+	NVIC_EnableIRQ(UART0_IRQn);
+}
+
+/*
+ * @brief Reads one accelerometer frame, the I2C engine waits for the bus most of the time
+ *
+ * @param fn copy of mma_read_xyz to call
+ * @return void
+ */
+static void bench_read_xyz(uintptr_t fn)
+{
+	int16_t xyz[3];
+	((void (*)(int16_t *))fn)(xyz);
+}
+
+/*
+ * @brief Looks up a colour in the middle of a ramp
+ *
+ * @param fn copy of guidance_colour to call
+ * @return void
+ */
+static void bench_guidance(uintptr_t fn)
+{
+	((const guidance_colour_t *(*)(guidance_ramp_t, int, int))fn)(GUIDANCE_CLOSE, 10, 30);
+}
+
+static const ramfunc_entry_t ramfuncs[] =
+{
+	{"UART0_IRQHandler", UART0_IRQHandler, 0, bench_uart_isr},
+	{"Q_Enqueue", (void (*)(void))Q_Enqueue, 0, bench_enqueue},
+	{"Q_Dequeue", (void (*)(void))Q_Dequeue, 0, bench_dequeue},
+	{"Q_Empty", (void (*)(void))Q_Empty, 0, NULL},
+	{"Q_Full", (void (*)(void))Q_Full, 0, NULL},
+	{"i2c_wait", i2c_wait, 0, NULL},
+	{"i2c_start", i2c_start, 0, NULL},
+	{"i2c_read_setup", (void (*)(void))i2c_read_setup, 0, NULL},
+	{"i2c_repeated_read", (void (*)(void))i2c_repeated_read, 0, NULL},
+	{"mma_read_xyz", (void (*)(void))mma_read_xyz, 0, bench_read_xyz},
+	{"guidance_colour", (void (*)(void))guidance_colour, GUIDANCE_TABLE_BYTES, bench_guidance},
+#if IRQ_STATS_ENABLE
+	{"irqstat_record", (void (*)(void))irqstat_record, 0, NULL},
+#endif
+};
+
+#define NUM_RAMFUNCS (sizeof(ramfuncs) / sizeof(ramfuncs[0]))
+
+
+/*
+ * @brief Finds the flash load image of a RAM-resident function in the data section table
+ *
+ * @param fn address of the function in SRAM
+ * @return address of the flash image with the same thumb bit, 0 if fn is not in a data section
+ */
+static uintptr_t flash_image(uintptr_t fn)
+{
+	unsigned int *entry = &__data_section_table;
+	uintptr_t address = fn & ~1U;
+	while (entry < &__data_section_table_end)
+	{
+		uintptr_t load = entry[0];
+		uintptr_t exe = entry[1];
+		uintptr_t length = entry[2];
+		entry += 3;
+		if ((address >= exe) && (address < exe + length))
+		{
+			return load + (fn - exe);
+		}
+	}
+	return 0;
+}
+
+/*
+ * @brief Code bytes of a RAM-resident function, up to the next one or the end of .ramfunc
+ *
+ * @param index entry in the table
+ * @return bytes of SRAM
+ */
+static uint32_t code_bytes(unsigned int index)
+{
+	uintptr_t start = (uintptr_t)ramfuncs[index].fn & ~1U;
+	uintptr_t end = (uintptr_t)&ramfunc_end;
+	for (unsigned int i = 0; i < NUM_RAMFUNCS; i++)
+	{
+		uintptr_t other = (uintptr_t)ramfuncs[i].fn & ~1U;
+		if ((other > start) && (other < end))
+		{
+			end = other;
+		}
+	}
+	return (end > start) ? (uint32_t)(end - start) : 0;
+}
+
+/*
+ * @brief Runs a benchmark with interrupts masked and returns the fastest run
+ *
+ * @param1 bench benchmark to run
+ * @param2 fn copy of the function to pass to the benchmark
+ * @return core clock cycles
+ */
+static uint32_t measure(bench_t bench, uintptr_t fn)
+{
+	uint32_t best = UINT32_MAX;
+	for (int run = 0; run < RAMFUNC_BENCH_RUNS; run++)
+	{
+		crit_state_t primask = crit_enter(CRIT_RAM_BENCH);
+		uint32_t start = timebase_cycles();
+		bench(fn);
+		uint32_t cycles = timebase_cycles() - start;
+		crit_exit(CRIT_RAM_BENCH, primask);
+		if (cycles < best)
+		{
+			best = cycles;
+		}
+	}
+	return best;
+}
+
+/*
+ * @brief Prints the RAM cost of every RAM-resident function and the cycles it takes when
+ * 		  run from SRAM and from its flash load image
+ *
+ * @return void
+ */
+void ramfunc_report(void)
+{
+	uintptr_t first = (uintptr_t)ramfuncs[0].fn & ~1U;
+	if (!RAMFUNC_ENABLE || (first < SRAM_START) || (first >= SRAM_END))
+	{
+		printf("RAM-resident functions are not enabled in this build\n\r");
+		return;
+	}
+
+	mma_start();						/*Needs the systick, which is masked while measuring*/
+
+	uint32_t total_bytes = 0;
+	printf("Function\t\tAddress\t\tRAM(B)\tFlash(cyc)\tRAM(cyc)\tSaved\n\r");
+	for (unsigned int i = 0; i < NUM_RAMFUNCS; i++)
+	{
+		const ramfunc_entry_t *entry = &ramfuncs[i];
+		uint32_t bytes = code_bytes(i) + entry->data_bytes;
+		total_bytes += bytes;
+		printf("%-16s\t0x%08lx\t%lu", entry->name, (unsigned long)((uintptr_t)entry->fn & ~1U),
+				(unsigned long)bytes);
+
+		uintptr_t flash = flash_image((uintptr_t)entry->fn);
+		if ((entry->bench == NULL) || (flash == 0))
+		{
+			printf("\t-\t\t-\t\t-\n\r");
+			continue;
+		}
+		uint32_t flash_cycles = measure(entry->bench, flash);
+		uint32_t ram_cycles = measure(entry->bench, (uintptr_t)entry->fn);
+		printf("\t%lu\t\t%lu\t\t%ld\n\r", (unsigned long)flash_cycles, (unsigned long)ram_cycles,
+				(long)flash_cycles - (long)ram_cycles);
+	}
+	printf("Total SRAM used: %lu bytes\n\r", (unsigned long)total_bytes);
+}
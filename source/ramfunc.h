@@ -0,0 +1,54 @@
+/**
+ * @file    ramfunc.h
+ * @brief   This header file consists of the placement macros and function prototypes used
+ * 			to run hot functions and lookup tables from SRAM
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * The flash is clocked from the bus clock, so at a 48 MHz core every instruction fetch
+ * which misses the flash prefetch buffer waits for a flash cycle. Functions marked RAMFUNC
+ * are placed in the .ramfunc section, which the managed linker script puts at the start of
+ * .data; ResetISR() copies them from flash together with the initialized data. Tables
+ * marked RAMDATA are placed in .data the same way. Define RAMFUNC_ENABLE as 0 to leave
+ * everything in flash.
+ *
+ * Every RAMFUNC function has to be listed in the table of ramfunc.c, the RAM cost of a
+ * function is measured as the distance to the next one.
+ */
+
+#ifndef RAMFUNC_H_
+#define RAMFUNC_H_
+
+#if !defined(RAMFUNC_ENABLE)
+#define RAMFUNC_ENABLE 1
+#endif
+
+#if RAMFUNC_ENABLE
+
+/*Not inlined, an inlined copy would run from the flash of the caller*/
+#define RAMFUNC		__attribute__((section(".ramfunc.$RAM"), noinline))
+#define RAMDATA		__attribute__((section(".data.$RAM")))
+
+#else
+
+#define RAMFUNC
+#define RAMDATA
+
+#endif
+
+#define RAMFUNC_BENCH_RUNS 8			/*The fastest run is reported*/
+
+
+/*
+ * @brief Prints the RAM cost of every RAM-resident function and the cycles it takes when
+ * 		  run from SRAM and from its flash load image
+ *
+ * Both copies are identical, calls between RAM-resident functions are PC relative, so the
+ * flash image runs entirely from flash
+ *
+ * @return void
+ */
+void ramfunc_report(void);
+
+#endif /* RAMFUNC_H_ */
@@ -0,0 +1,194 @@
+/**
+ * @file    selftest.c
+ * @brief   This source file consists of function definitions of the power-on self-test,
+ * 			selected by the persisted boot mode
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "selftest.h"
+#include "test_cbfifo.h"
+#include "test_switch.h"
+#include "test_leds.h"
+#include "test_accelerometer.h"
+#include "test_timer.h"
+
+#define TEST_BIT(test) (1u << (test))
+
+typedef struct
+{
+	const char *name;
+	bool quick;						/*Needs no user action nor a lazily started peripheral, takes tens of msec at most*/
+} selftest_info_t;
+
+static const selftest_info_t tests[SELFTEST_COUNT] = {{"Switch", false}, {"CBFIFO", true}, {"LED's", false},
+													 {"Accelerometer", false}, {"Accelerometer self-test", false},
+													 {"Timers", false}};
+static const char *boot_mode_names[BOOT_NUM_MODES] = {"full", "quick", "skip"};
+
+static settings_t settings;
+
+
+/*
+ * @brief Runs one self-test
+ *
+ * @param test test to run
+ * @return true if passed
+ */
+static bool run_test(selftest_t test)
+{
+	switch (test)
+	{
+		case SELFTEST_SWITCH:
+			return test_switch();
+		case SELFTEST_CBFIFO:
+			return test_cbfifo();
+		case SELFTEST_LEDS:
+			return test_leds();
+		case SELFTEST_ACCELEROMETER:
+			return test_accelerometer();
+		case SELFTEST_ACCELEROMETER_SELF_TEST:
+			return test_accelerometer_self_test();
+		case SELFTEST_TIMER:
+			return test_timer();
+		default:
+			return false;
+	}
+}
+
+/*
+ * @brief Loads the settings and runs the self-tests of the stored boot mode
+ *
+ * @return void
+ */
+void selftest_boot(void)
+{
+	if (!settings_load(&settings))
+	{
+		printf("No stored settings, using the defaults\n\r");
+	}
+	printf("Boot mode %s, type boot to change it or test to run every self-test\n\r",
+			boot_mode_names[settings.boot_mode]);
+	if (settings.boot_mode != BOOT_SKIP)
+	{
+		selftest_run((boot_mode_t)settings.boot_mode);
+	}
+	else if (settings.tests_run != 0)
+	{
+		printf("Cached self-test results: %s\n\r",
+				((settings.tests_passed & settings.tests_run) == settings.tests_run) ? "all passed" : "failures, type boot for details");
+	}
+}
+
+/*
+ * @brief Runs the self-tests of a boot mode and caches their results in flash
+ *
+ * @param mode BOOT_FULL for every test, BOOT_QUICK for the quick ones
+ * @return true if every test which ran passed
+ */
+bool selftest_run(boot_mode_t mode)
+{
+	settings_t previous = settings;
+	int number = 1;
+	int count = 0;
+	int run = 0;
+
+	if (mode == BOOT_FULL)
+	{
+		printf("-----------Testing the Digital Gauge peripherals----------\n\r");
+		for (int test = 0; test < SELFTEST_COUNT; test++)
+		{
+			printf("%d. Testing %s\n\r", number++, tests[test].name);
+		}
+		printf("----------------------------------------------------------\n\r\n\r");
+	}
+	for (int test = 0; test < SELFTEST_COUNT; test++)
+	{
+		if ((mode != BOOT_FULL) && !tests[test].quick)
+		{
+			continue;
+		}
+		run++;
+		settings.tests_run |= TEST_BIT(test);
+		if (run_test((selftest_t)test))
+		{
+			count = count + 1;
+			settings.tests_passed |= TEST_BIT(test);
+		}
+		else
+		{
+			settings.tests_passed &= ~TEST_BIT(test);
+		}
+	}
+	if (count == run)
+	{
+		printf("All peripheral test cases are passed successfully \n\r");
+	}
+	else
+	{
+		printf("All peripheral test cases are not passed successfully\n\r");
+	}
+	if (memcmp(&previous, &settings, sizeof(settings)) != 0)		/*Only wear the flash when a result changed*/
+	{
+		settings_save(&settings);
+	}
+	return count == run;
+}
+
+/*
+ * @brief Stores the boot mode used from the next power-up
+ *
+ * @param mode new boot mode
+ * @return true if stored in flash
+ */
+bool selftest_set_boot_mode(boot_mode_t mode)
+{
+	if (settings.boot_mode == mode)
+	{
+		return true;
+	}
+	settings.boot_mode = mode;
+	return settings_save(&settings);
+}
+
+/*
+ * @brief Finds a boot mode from its name
+ *
+ * @param1 name full, quick or skip
+ * @param2 mode set to the boot mode if found
+ * @return true if the name is a boot mode
+ */
+bool selftest_boot_mode_from_name(const char *name, boot_mode_t *mode)
+{
+	for (int index = 0; index < BOOT_NUM_MODES; index++)
+	{
+		if (strcasecmp(name, boot_mode_names[index]) == 0)
+		{
+			*mode = (boot_mode_t)index;
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * @brief Prints the boot mode and the cached result of every self-test
+ *
+ * @return void
+ */
+void selftest_report(void)
+{
+	printf("Boot mode %s\n\r", boot_mode_names[settings.boot_mode]);
+	for (int test = 0; test < SELFTEST_COUNT; test++)
+	{
+		const char *result = "not run";
+		if (settings.tests_run & TEST_BIT(test))
+		{
+			result = (settings.tests_passed & TEST_BIT(test)) ? "passed" : "failed";
+		}
+		printf("  %s\t%s%s\n\r", tests[test].name, result, tests[test].quick ? "" : " (full only)");
+	}
+}
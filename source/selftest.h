@@ -0,0 +1,73 @@
+/**
+ * @file    selftest.h
+ * @brief   This header file consists of function prototypes of the power-on self-test,
+ * 			selected by the persisted boot mode
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * The full suite waits for the user (switch press, LED check, board tilts) and takes
+ * more than 25 seconds, so by default only the quick tests run at boot. The result of
+ * every test is cached in flash with the boot mode, a test which did not run in this
+ * boot reports its cached result.
+ */
+
+#ifndef SELFTEST_H_
+#define SELFTEST_H_
+
+#include <stdbool.h>
+#include "settings.h"
+
+typedef enum
+{
+	SELFTEST_SWITCH = 0,
+	SELFTEST_CBFIFO,
+	SELFTEST_LEDS,
+	SELFTEST_ACCELEROMETER,
+	SELFTEST_ACCELEROMETER_SELF_TEST,
+	SELFTEST_TIMER,
+	SELFTEST_COUNT
+} selftest_t;
+
+
+/*
+ * @brief Loads the settings and runs the self-tests of the stored boot mode
+ *
+ * @return void
+ */
+void selftest_boot(void);
+
+/*
+ * @brief Runs the self-tests of a boot mode and caches their results in flash
+ *
+ * @param mode BOOT_FULL for every test, BOOT_QUICK for the quick ones
+ * @return true if every test which ran passed
+ */
+bool selftest_run(boot_mode_t mode);
+
+/*
+ * @brief Stores the boot mode used from the next power-up
+ *
+ * @param mode new boot mode
+ * @return true if stored in flash
+ */
+bool selftest_set_boot_mode(boot_mode_t mode);
+
+/*
+ * @brief Finds a boot mode from its name
+ *
+ * @param1 name full, quick or skip
+ * @param2 mode set to the boot mode if found
+ * @return true if the name is a boot mode
+ */
+bool selftest_boot_mode_from_name(const char *name, boot_mode_t *mode);
+
+/*
+ * @brief Prints the boot mode and the cached result of every self-test
+ *
+ * @return void
+ */
+void selftest_report(void);
+
+
+#endif /* SELFTEST_H_ */
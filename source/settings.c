@@ -0,0 +1,113 @@
+/**
+ * @file    settings.c
+ * @brief   This source file consists of function definitions to load the persistent
+ * 			settings from and save them to the key/value store in flash
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ */
+
+#include <string.h>
+#include "settings.h"
+#include "kvstore.h"
+
+typedef struct
+{
+	uint8_t tests_run;
+	uint8_t tests_passed;
+} selftest_cache_t;
+
+
+/*
+ * @brief Reads the boot mode and the cached self-test results from flash
+ *
+ * @param settings filled with the stored settings, or the defaults
+ * @return true if a stored boot mode was found, false if the defaults were used
+ */
+bool settings_load(settings_t *settings)
+{
+	uint8_t boot_mode;
+	selftest_cache_t cache;
+
+	memset(settings, 0, sizeof(*settings));
+	settings->boot_mode = SETTINGS_DEFAULT_BOOT_MODE;
+	if (kv_get(KV_KEY_SELFTEST, &cache, sizeof(cache)))
+	{
+		settings->tests_run = cache.tests_run;
+		settings->tests_passed = cache.tests_passed;
+	}
+	if (kv_get(KV_KEY_BOOT_MODE, &boot_mode, sizeof(boot_mode)) && (boot_mode < BOOT_NUM_MODES))
+	{
+		settings->boot_mode = boot_mode;
+		return true;
+	}
+	return false;
+}
+
+/*
+ * @brief Writes the boot mode and the cached self-test results to flash
+ *
+ * @param settings settings to store
+ * @return true if the settings were written and verified
+ */
+bool settings_save(const settings_t *settings)
+{
+	selftest_cache_t cache = {settings->tests_run, settings->tests_passed};
+
+	bool saved = kv_set(KV_KEY_BOOT_MODE, &settings->boot_mode, sizeof(settings->boot_mode));
+	return kv_set(KV_KEY_SELFTEST, &cache, sizeof(cache)) && saved;
+}
+
+/*
+ * @brief Reads the reference set by the calibrate command from flash
+ *
+ * @param calibration filled with the stored calibration
+ * @return true if a stored calibration was found, calibration is unchanged otherwise
+ */
+bool calibration_load(calibration_t *calibration)
+{
+	return kv_get(KV_KEY_CALIBRATION, calibration, sizeof(*calibration));
+}
+
+/*
+ * @brief Writes the reference set by the calibrate command to flash
+ *
+ * @param calibration calibration to store
+ * @return true if the calibration was written and verified
+ */
+bool calibration_save(const calibration_t *calibration)
+{
+	return kv_set(KV_KEY_CALIBRATION, calibration, sizeof(*calibration));
+}
+
+/*
+ * @brief Reads the accelerometer offset and gain calibration from flash
+ *
+ * @param calibration filled with the stored calibration
+ * @return true if a stored calibration was found, calibration is unchanged otherwise
+ */
+bool sensor_calibration_load(mma_calibration_t *calibration)
+{
+	return kv_get(KV_KEY_SENSOR_CALIBRATION, calibration, sizeof(*calibration));
+}
+
+/*
+ * @brief Writes the accelerometer offset and gain calibration to flash
+ *
+ * @param calibration calibration to store
+ * @return true if the calibration was written and verified
+ */
+bool sensor_calibration_save(const mma_calibration_t *calibration)
+{
+	return kv_set(KV_KEY_SENSOR_CALIBRATION, calibration, sizeof(*calibration));
+}
+
+/*
+ * @brief Prints the state of the key/value store holding the settings
+ *
+ * @return void
+ */
+void settings_report(void)
+{
+	kv_report();
+}
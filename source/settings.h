@@ -0,0 +1,109 @@
+/**
+ * @file    settings.h
+ * @brief   This header file consists of the persistent settings and function prototypes
+ * 			to load them from and save them to the key/value store in flash
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * Every group of settings is a key of the store, so saving one group does not rewrite
+ * the others and an unchanged group is not written at all. A missing or corrupted value
+ * reads back as the defaults.
+ *
+ * The store is kept in the last sectors of the program flash, the image must not grow
+ * in to them. The PROGRAM_FLASH region of the project's memory configuration ends below
+ * them and the sample log, so a link which would overlap either fails.
+ */
+
+#ifndef SETTINGS_H_
+#define SETTINGS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "accelerometer.h"
+
+typedef enum
+{
+	BOOT_FULL = 0,					/*Every self-test, including the ones needing the user*/
+	BOOT_QUICK,						/*Only the self-tests which need no user action nor the I2C/MMA bring-up*/
+	BOOT_SKIP,						/*No self-test, the cached results are shown*/
+	BOOT_NUM_MODES
+} boot_mode_t;
+
+#define SETTINGS_DEFAULT_BOOT_MODE BOOT_QUICK
+
+typedef struct
+{
+	uint8_t boot_mode;				/*boot_mode_t*/
+	uint8_t tests_run;				/*Bit per self-test which has a cached result*/
+	uint8_t tests_passed;			/*Bit per self-test which passed when it last ran*/
+	uint8_t reserved;
+} settings_t;
+
+typedef struct
+{
+	int16_t reference;				/*Roll set as zero by the calibrate command*/
+	int16_t maximum_angle;			/*Largest angle measurable from the reference*/
+} calibration_t;
+
+
+/*
+ * @brief Reads the boot mode and the cached self-test results from flash
+ *
+ * @param settings filled with the stored settings, or the defaults
+ * @return true if a stored boot mode was found, false if the defaults were used
+ */
+bool settings_load(settings_t *settings);
+
+/*
+ * @brief Writes the boot mode and the cached self-test results to flash
+ *
+ * Interrupts are masked while the flash is programmed. Once in a few hundred writes the
+ * store is compacted, which erases a sector and takes up to a few tens of msec
+ *
+ * @param settings settings to store
+ * @return true if the settings were written and verified
+ */
+bool settings_save(const settings_t *settings);
+
+/*
+ * @brief Reads the reference set by the calibrate command from flash
+ *
+ * @param calibration filled with the stored calibration
+ * @return true if a stored calibration was found, calibration is unchanged otherwise
+ */
+bool calibration_load(calibration_t *calibration);
+
+/*
+ * @brief Writes the reference set by the calibrate command to flash
+ *
+ * @param calibration calibration to store
+ * @return true if the calibration was written and verified
+ */
+bool calibration_save(const calibration_t *calibration);
+
+/*
+ * @brief Reads the accelerometer offset and gain calibration from flash
+ *
+ * @param calibration filled with the stored calibration
+ * @return true if a stored calibration was found, calibration is unchanged otherwise
+ */
+bool sensor_calibration_load(mma_calibration_t *calibration);
+
+/*
+ * @brief Writes the accelerometer offset and gain calibration to flash
+ *
+ * @param calibration calibration to store
+ * @return true if the calibration was written and verified
+ */
+bool sensor_calibration_save(const mma_calibration_t *calibration);
+
+/*
+ * @brief Prints the state of the key/value store holding the settings
+ *
+ * @return void
+ */
+void settings_report(void);
+
+
+#endif /* SETTINGS_H_ */
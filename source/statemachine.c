@@ -18,115 +18,78 @@
 #include "accelerometer.h"
 #include "sysclock.h"
 #include "uart.h"
-#include "test_cbfifo.h"
-#include "test_switch.h"
-#include "test_cbfifo.h"
-#include "test_leds.h"
-#include "test_accelerometer.h"
+#include "selftest.h"
+#include "events.h"
+#include "swtimer.h"
+#include "deferred.h"
+#include "boottime.h"
+#include "critical.h"
+#include "probe.h"
 
-#define PASS 1						/*To store the result of test function*/
-#define FAIL 0
-
-typedef enum
-{
-	INITIALIZE=0,
-	TEST,
-	GET_INPUT
-
-}state_t;
+#define WARMUP_DELAY_MS 10				/*Lazy peripherals are started this long after the prompt*/
 
+static swtimer_t warmup_timer;
 
 /*
  * @brief Function to initialize peripherals used to in this project
  *
+ * Only what the console needs is initialized here, every step is timed for the boot
+ * timeline. The LEDs and the accelerometer start on first use, or from the warmup timer
+ * while the console waits for input
+ *
  * @return void
  */
 static void initialize_peripherals()
 {
    	sysclock_init();								/*Initializing the system clock as per UART requirements*/
-	init_uart0();								    /*Initializes the UART 0 peripheral of KL25Z board*/
-	Init_Red_LED_PWM(PWM_PERIOD);					/*Initializes the Timer PWM module 2 channel 0 connected to red led (Port B 18)*/
-	Init_Green_LED_PWM(PWM_PERIOD);					/* Initializes the Timer PWM module 2 channel 1 connected to green led (Port B 19)*/
-	Init_Blue_LED_PWM(PWM_PERIOD);					/* Initializes the Timer PWM module 0 channel 1 connected to blue led (Port D 1)*/
-	i2c_init();										/* Initialize i2c*/
-	init_mma();										/* Initialize the accelerometer*/
-	init_switch();									/* Initialize the GPIO switch*/
-	Init_SysTick();									/* Initialize the systick timer used to calculate delay*/
-
+	Init_SysTick();									/* Initialize the systick timer first, it times the other steps*/
+	BOOT_STEP("Critical sections", crit_init());	/*Starts timing the interrupt masked sections*/
+	BOOT_STEP("Probes", probe_init());				/*Spare header pins for a logic analyzer, if built in*/
+	BOOT_STEP("PendSV", deferred_init());			/*PendSV priority for the interrupt bottom halves*/
+	BOOT_STEP("UART", init_uart0());				/*Initializes the UART 0 peripheral of KL25Z board*/
+	BOOT_STEP("Switch", init_switch());				/* Initialize the GPIO switch*/
 }
 
 /*
- * @brief Test function to test peripherals
+ * @brief Warmup timer callback, starts the peripherals which are not needed for the prompt
  *
+ * @param arg unused
  * @return void
  */
-static void test()
+static void warmup(void *arg)
 {
-	int count = 0;
-	printf("-----------Testing the Digital Gauge peripherals----------\n\r");
-	printf("1. Testing Switch\n\r");
-	printf("2. Testing CBFIFO\n\r");
-	printf("3. Testing LED's\n\r");
-	printf("4. Testing Accelerometer\n\r");
-	printf("----------------------------------------------------------\n\r\n\r");
-	if(test_switch())
-	{
-		count = count + 1;
-	}
-	if(test_cbfifo())
-	{
-		count = count + 1;
-	}
-	if(test_leds())
-	{
-		count = count + 1;
-	}
-	if(test_accelerometer())
-	{
-		count = count + 1;
-
-	}
-	if (count == 4)
-	{
-		printf("All peripheral test cases are passed successfully \n\r");		/*If all 4 are true, all peripherals are working properly*/
-	}
-	else
-	{
-		printf("All peripheral test cases are not passed successfully\n\r");
-	}
-
+	leds_start();
+	mma_start();
 }
 
-
-
+/*
+ * @brief Timer expiry event handler, runs the expired software timer callbacks
+ *
+ * @param event EVENT_TIMER
+ * @return void
+ */
+static void timer_event(event_t event)
+{
+	swtimer_service();
+}
 
 /*
  * @brief The state machine for digial guage meter
  *
+ * Initializes the peripherals, runs the self-tests of the stored boot mode and then
+ * runs the event loop: every further step runs to completion from an event posted by
+ * an interrupt, and the core sleeps in between
+ *
  * @return void
  */
 void statemachine()
 {
-	state_t currentState = INITIALIZE;
-	while(1)
-	{
-		switch (currentState)
-		{
-			case INITIALIZE:
-				initialize_peripherals();
-				currentState = TEST;
-			break;
-
-			case TEST:
-				test();
-				currentState = GET_INPUT;
-			break;
-
-			case GET_INPUT:
-				printf("? ");
-				accumulator();
-			break;
-		}
-	}
+	initialize_peripherals();
+	BOOT_STEP("Self-test", selftest_boot());
+	event_register(EVENT_TIMER, timer_event);
+	command_init();
+	boottime_mark("First prompt");
+	swtimer_oneshot(&warmup_timer, "warmup", WARMUP_DELAY_MS, warmup, NULL);
+	events_run();
 }
 
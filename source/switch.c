@@ -15,6 +15,12 @@
 #include <stdbool.h>
 #include "MKL25Z4.h"
 #include "switch.h"
+#include "critical.h"
+#include "irqstat.h"
+#include "events.h"
+#include "deferred.h"
+#include "timer.h"
+#include "blog.h"
 
 
 #define SWITCH_GPIO_PORT GPIOD
@@ -22,9 +28,15 @@
 #define SWITCH_PIN_CTRL_REG PORTD->PCR[SWITCH_PIN]
 #define SWITCH_SCGC5_MASK SIM_SCGC5_PORTD_MASK
 #define SWITCH_ISFR PORTD->ISFR
-#define INTERRUPT_WHEN_LOGIC_ZERO 8
+#define INTERRUPT_ON_FALLING_EDGE 0xA
+#define INTERRUPT_DISABLED 0
+#define SWITCH_DEBOUNCE_MS 50				/*The switch must read released this long before the next press*/
 
 static int interrupt_triggered = 0; /*Flag set when switch interrupt is triggered*/
+static volatile bool press_latched = false;	/*Set by the top half until the bottom half has run*/
+static volatile ticktime press_tick = 0;		/*Tick of the latched edge*/
+static volatile bool rearm_pending = false;	/*Set while the pin interrupt is disarmed after a press*/
+static ticktime released_since = 0;			/*Tick the switch last read pressed while disarmed*/
 
 /*
  * @brief Initialize the on-board switch to trigger cross-walk state of KL25Z freedom development board
@@ -46,8 +58,8 @@ void init_switch()
   SWITCH_GPIO_PORT->PDDR &= ~(1 << SWITCH_PIN);/*Setting the data direction to input*/
 
 
-  SWITCH_PIN_CTRL_REG |=PORT_PCR_IRQC(INTERRUPT_WHEN_LOGIC_ZERO);/*Configuring interrupt for logic zero*/
-  NVIC_SetPriority (PORTD_IRQn, 4);/*Setting up NVIC priority greater than 3*/
+  SWITCH_PIN_CTRL_REG |=PORT_PCR_IRQC(INTERRUPT_ON_FALLING_EDGE);/*Configuring interrupt for the falling edge of a press*/
+  NVIC_SetPriority (PORTD_IRQn, 2);/*Above the PendSV bottom halves, which own the lowest level 3*/
   NVIC_EnableIRQ(PORTD_IRQn);/*Enabling the interrupt*/
   __enable_irq();/*If the PM bit in PRIMASK register is set,__enable_irq will enable the interrupt*/
 }
@@ -71,26 +83,85 @@ void reset_switch()
  */
 int check_switch_pressed(void)
 {
-		uint32_t masking_state = __get_PRIMASK();
-		__disable_irq();						/*Avoiding racing condition by disabling the interrupt*/
+		crit_state_t masking_state = crit_enter(CRIT_SWITCH);	/*Avoiding racing condition by disabling the interrupt*/
 		int button_pressed = interrupt_triggered;
 		interrupt_triggered = 0;
-		__set_PRIMASK(masking_state);			/*Enabling the interrupt*/
+		crit_exit(CRIT_SWITCH, masking_state);	/*Enabling the interrupt*/
 		return button_pressed;
 }
 
+/*
+ * @brief Bottom half of the switch interrupt, reports the latched press
+ *
+ * The flag is set and EVENT_SWITCH is posted; the bounces never get here, the pin
+ * interrupt is disarmed until switch_tick() sees the switch released
+ *
+ * @param arg unused
+ * @return void
+ */
+static void switch_bottom_half(void *arg)
+{
+	ticktime tick = press_tick;
+	press_latched = false;
+	interrupt_triggered = 1;
+	BLOG1("switch: press at tick %lu", tick);
+	event_post(EVENT_SWITCH);
+}
+
+/*
+ * @brief Debounce timer, called from the systick handler every tick
+ *
+ * Runs at the priority of the PORTD interrupt, so the two never preempt each other
+ * while the pin control register is rewritten
+ *
+ * @param now current tick count
+ * @return void
+ */
+void switch_tick(ticktime now)
+{
+	if (!rearm_pending)
+	{
+		return;
+	}
+	if ((SWITCH_GPIO_PORT->PDIR & (1 << SWITCH_PIN)) == 0)	/*Still pressed, or bouncing*/
+	{
+		released_since = now;
+		return;
+	}
+	if ((now - released_since) >= SWITCH_DEBOUNCE_MS)
+	{
+		SWITCH_ISFR = (1 << SWITCH_PIN);			/*Drop an edge flagged while disarmed*/
+		SWITCH_PIN_CTRL_REG = (SWITCH_PIN_CTRL_REG & ~(PORT_PCR_IRQC_MASK | PORT_PCR_ISF_MASK)) |
+								PORT_PCR_IRQC(INTERRUPT_ON_FALLING_EDGE);
+		rearm_pending = false;
+	}
+}
+
 /*
  * @brief Interrupt routine called when user presses the button connected to PORT D 3rd pin
  *
- * When the interrupt is triggered, a flag is set and the IFSR register is written 1 to
- * clear the interrupt which was set
+ * Top half: the IFSR register is written 1 to clear the interrupt which was set, the pin
+ * interrupt is disarmed so the bounces and a held button cannot fire it again, and the
+ * tick of the edge is latched for the bottom half. switch_tick() arms it again
  *
  * @return void
  */
 void PORTD_IRQHandler(void)
 {
-	if ( ( (SWITCH_ISFR) & (1 << SWITCH_PIN) ) == 0) /*Check if switch is pressed*/
-	return;
-	interrupt_triggered = 1;
-	SWITCH_ISFR &= (1 << SWITCH_PIN); /*Writing 1 will clear the bit 3 PORT D IFSR register*/
+	IRQ_STAT_ENTER(IRQ_LATENCY_UNKNOWN);
+	if ( ( (SWITCH_ISFR) & (1 << SWITCH_PIN) ) != 0) /*Check if switch is pressed*/
+	{
+		SWITCH_ISFR = (1 << SWITCH_PIN); /*Writing 1 will clear the bit 3 PORT D IFSR register*/
+		SWITCH_PIN_CTRL_REG = (SWITCH_PIN_CTRL_REG & ~(PORT_PCR_IRQC_MASK | PORT_PCR_ISF_MASK)) |
+								PORT_PCR_IRQC(INTERRUPT_DISABLED);
+		released_since = timebase_ticks();
+		rearm_pending = true;
+		if (!press_latched)
+		{
+			press_latched = true;
+			press_tick = timebase_ticks();
+			deferred_post(switch_bottom_half, NULL);
+		}
+	}
+	IRQ_STAT_EXIT(IRQ_STAT_PORTD);
 }
@@ -14,6 +14,7 @@
 #ifndef SWITCH_H_
 #define SWITCH_H_
 
+#include "timer.h"
 
 /*
  * @brief Initialize the on-board switch to trigger cross-walk state of KL25Z freedom development board
@@ -41,5 +42,17 @@ int check_switch_pressed();
  */
 void reset_switch();
 
+/*
+ * @brief Debounce timer, called from the systick handler every tick
+ *
+ * After a press the pin interrupt stays disarmed; it is armed again for the next falling
+ * edge once the switch has read released for SWITCH_DEBOUNCE_MS, so neither the bounces
+ * nor a held button trigger another press
+ *
+ * @param now current tick count
+ * @return void
+ */
+void switch_tick(ticktime now);
+
 
 #endif /* SWITCH_H_ */
@@ -0,0 +1,274 @@
+/**
+ * @file    swtimer.c
+ * @brief   This source file consists of function definitions of the software timer service
+ * 			which runs one-shot and periodic callbacks from the main loop, driven by the systick
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * Active timers are kept in a list sorted by due tick. The list is only modified from
+ * the main loop; the systick handler just compares the tick count with the due tick of
+ * the head of the list, raises a flag and posts EVENT_TIMER, so no critical section is
+ * needed to start or stop a timer.
+ */
+
+#include <stdio.h>
+#include "swtimer.h"
+#include "timer.h"
+#include "idle.h"
+#include "events.h"
+
+#define MICROSECONDS_PER_TICK (1000 * TICK_PERIOD_MS)
+
+static swtimer_t *active_timers = NULL;		/*Sorted by due tick, earliest first*/
+static volatile ticktime next_due = 0;		/*Due tick of the head of the list, read by the systick*/
+static volatile bool timers_armed = false;	/*Set while the list is not empty*/
+static volatile bool timers_expired = false; /*Set by the systick when the head is due*/
+static bool servicing = false;				/*Guards against nested swtimer_service() calls*/
+
+
+/*
+ * @brief To check whether tick a is at or after tick b, correct across the tick wrap
+ *
+ * @return true if a is not before b
+ */
+static bool tick_reached(ticktime a, ticktime b)
+{
+	return (int32_t)(a - b) >= 0;
+}
+
+/*
+ * @brief Flags the head of the list as due and wakes the main loop, once per expiry
+ *
+ * @return void
+ */
+static void flag_expired(void)
+{
+	if (!timers_expired)
+	{
+		timers_expired = true;
+		event_post(EVENT_TIMER);
+	}
+}
+
+/*
+ * @brief Publishes the due tick of the head of the list to the systick handler
+ *
+ * @return void
+ */
+static void update_next_due(void)
+{
+	if (active_timers == NULL)
+	{
+		timers_armed = false;
+		return;
+	}
+	next_due = active_timers->due;
+	timers_armed = true;
+	if (tick_reached(timebase_ticks(), next_due))		/*Became due while updating*/
+	{
+		flag_expired();
+	}
+}
+
+/*
+ * @brief Removes a timer from the active list
+ *
+ * @param timer timer control block
+ * @return void
+ */
+static void unlink_timer(swtimer_t *timer)
+{
+	swtimer_t **link = &active_timers;
+	while (*link != NULL)
+	{
+		if (*link == timer)
+		{
+			*link = timer->next;
+			break;
+		}
+		link = &(*link)->next;
+	}
+	timer->next = NULL;
+	timer->active = false;
+}
+
+/*
+ * @brief Inserts a timer in to the active list sorted by due tick
+ *
+ * Timers with the same due tick run in the order they were inserted
+ *
+ * @param timer timer control block
+ * @return void
+ */
+static void link_timer(swtimer_t *timer)
+{
+	swtimer_t **link = &active_timers;
+	while ((*link != NULL) && tick_reached(timer->due, (*link)->due))
+	{
+		link = &(*link)->next;
+	}
+	timer->next = *link;
+	*link = timer;
+	timer->active = true;
+}
+
+/*
+ * @brief Common code to start a one-shot or periodic timer
+ *
+ * @return void
+ */
+static void start_timer(swtimer_t *timer, const char *name, ticktime delay_ms, ticktime period_ms,
+		swtimer_callback_t callback, void *arg)
+{
+	if (timer->active)
+	{
+		unlink_timer(timer);
+	}
+	timer->name = name;
+	timer->callback = callback;
+	timer->arg = arg;
+	timer->period = period_ms / TICK_PERIOD_MS;
+	timer->due = timebase_ticks() + (delay_ms / TICK_PERIOD_MS);
+	timer->runs = 0;
+	timer->overruns = 0;
+	timer->max_lateness_us = 0;
+	link_timer(timer);
+	update_next_due();
+}
+
+/*
+ * @brief Starts a one-shot timer, the callback is run once from swtimer_service()
+ *
+ * @param1 timer timer control block, restarted if already active
+ * @param2 name name of the timer
+ * @param3 delay_ms time to expiry in msec
+ * @param4 callback function to run on expiry
+ * @param5 arg argument passed to the callback
+ * @return void
+ */
+void swtimer_oneshot(swtimer_t *timer, const char *name, ticktime delay_ms,
+		swtimer_callback_t callback, void *arg)
+{
+	start_timer(timer, name, delay_ms, 0, callback, arg);
+}
+
+/*
+ * @brief Starts a periodic timer, the callback is run every period_ms from swtimer_service()
+ *
+ * @param1 timer timer control block, restarted if already active
+ * @param2 name name of the timer
+ * @param3 period_ms period in msec
+ * @param4 callback function to run on expiry
+ * @param5 arg argument passed to the callback
+ * @return void
+ */
+void swtimer_periodic(swtimer_t *timer, const char *name, ticktime period_ms,
+		swtimer_callback_t callback, void *arg)
+{
+	if (period_ms < TICK_PERIOD_MS)
+	{
+		period_ms = TICK_PERIOD_MS;				/*A zero period would never leave the list*/
+	}
+	start_timer(timer, name, period_ms, period_ms, callback, arg);
+}
+
+/*
+ * @brief Stops a timer, does nothing if the timer is not active
+ *
+ * @param timer timer control block
+ * @return void
+ */
+void swtimer_stop(swtimer_t *timer)
+{
+	if (timer->active)
+	{
+		unlink_timer(timer);
+		update_next_due();
+	}
+}
+
+/*
+ * @brief To check whether a timer expiry is waiting for swtimer_service()
+ *
+ * @return true if swtimer_service() has callbacks to run
+ */
+bool swtimer_expired(void)
+{
+	return timers_expired;
+}
+
+/*
+ * @brief Called from the systick handler every tick to flag expired timers
+ *
+ * @param now current tick count
+ * @return void
+ */
+void swtimer_tick(ticktime now)
+{
+	if (timers_armed && tick_reached(now, next_due))
+	{
+		flag_expired();
+	}
+}
+
+/*
+ * @brief Runs the callbacks of all the expired timers, called from the main loop
+ *
+ * @return void
+ */
+void swtimer_service(void)
+{
+	if (!timers_expired || servicing)
+	{
+		return;
+	}
+	servicing = true;
+	timers_expired = false;
+
+	while ((active_timers != NULL) && tick_reached(timebase_ticks(), active_timers->due))
+	{
+		swtimer_t *timer = active_timers;
+		uint32_t lateness_us = timebase_us() - (timer->due * MICROSECONDS_PER_TICK);
+		if (lateness_us > timer->max_lateness_us)
+		{
+			timer->max_lateness_us = lateness_us;
+		}
+
+		unlink_timer(timer);
+		if (timer->period != 0)							/*Re-arm before the callback so it can stop itself*/
+		{
+			timer->due += timer->period;
+			while (tick_reached(timebase_ticks(), timer->due))
+			{
+				timer->due += timer->period;			/*Skip the periods which were missed completely*/
+				timer->overruns++;
+			}
+			link_timer(timer);
+		}
+		timer->runs++;
+		cpu_task_t previous = cpu_task_enter(CPU_TASK_TIMERS);
+		timer->callback(timer->arg);
+		cpu_task_exit(previous);
+	}
+
+	update_next_due();
+	servicing = false;
+}
+
+/*
+ * @brief Prints the active timers with their period, run count and jitter
+ *
+ * @return void
+ */
+void swtimer_report(void)
+{
+	swtimer_t *timer;
+	printf("Name\tPeriod(ms)\tRuns\tOverruns\tMax late(us)\n\r");
+	for (timer = active_timers; timer != NULL; timer = timer->next)
+	{
+		printf("%s\t%lu\t\t%lu\t%lu\t\t%lu\n\r", timer->name,
+				(unsigned long)(timer->period * TICK_PERIOD_MS), (unsigned long)timer->runs,
+				(unsigned long)timer->overruns, (unsigned long)timer->max_lateness_us);
+	}
+}
@@ -0,0 +1,110 @@
+/**
+ * @file    swtimer.h
+ * @brief   This header file consists of function prototypes of the software timer service
+ * 			which runs one-shot and periodic callbacks from the main loop, driven by the systick
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ */
+
+#ifndef SWTIMER_H_
+#define SWTIMER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+
+typedef void (*swtimer_callback_t)(void *arg);
+
+/*
+ * Timer control block, owned by the caller (usually a static variable) and linked
+ * in to the sorted list of active timers while running
+ */
+typedef struct swtimer
+{
+	const char *name;				/*Shown by the timers command*/
+	swtimer_callback_t callback;
+	void *arg;
+	ticktime due;					/*Absolute tick of the next expiry*/
+	ticktime period;				/*Ticks between expiries, 0 for a one-shot timer*/
+	bool active;
+	uint32_t runs;					/*Number of times the callback was run*/
+	uint32_t overruns;				/*Periods skipped because the callback ran too late*/
+	uint32_t max_lateness_us;		/*Worst delay between expiry and running the callback*/
+	struct swtimer *next;
+} swtimer_t;
+
+
+/*
+ * @brief Starts a one-shot timer, the callback is run once from swtimer_service()
+ *
+ * @param1 timer timer control block, restarted if already active
+ * @param2 name name of the timer
+ * @param3 delay_ms time to expiry in msec
+ * @param4 callback function to run on expiry
+ * @param5 arg argument passed to the callback
+ * @return void
+ */
+void swtimer_oneshot(swtimer_t *timer, const char *name, ticktime delay_ms,
+		swtimer_callback_t callback, void *arg);
+
+/*
+ * @brief Starts a periodic timer, the callback is run every period_ms from swtimer_service()
+ *
+ * Expiries are scheduled from the previous due time, not from when the callback ran,
+ * so the period does not drift
+ *
+ * @param1 timer timer control block, restarted if already active
+ * @param2 name name of the timer
+ * @param3 period_ms period in msec
+ * @param4 callback function to run on expiry
+ * @param5 arg argument passed to the callback
+ * @return void
+ */
+void swtimer_periodic(swtimer_t *timer, const char *name, ticktime period_ms,
+		swtimer_callback_t callback, void *arg);
+
+/*
+ * @brief Stops a timer, does nothing if the timer is not active
+ *
+ * @param timer timer control block
+ * @return void
+ */
+void swtimer_stop(swtimer_t *timer);
+
+/*
+ * @brief Runs the callbacks of all the expired timers, called from the main loop
+ *
+ * Returns immediately when no timer has expired. Not reentrant, a nested call from
+ * a callback (for example through delay()) returns without doing anything
+ *
+ * @return void
+ */
+void swtimer_service(void);
+
+/*
+ * @brief To check whether a timer expiry is waiting for swtimer_service()
+ *
+ * @return true if swtimer_service() has callbacks to run
+ */
+bool swtimer_expired(void);
+
+/*
+ * @brief Called from the systick handler every tick to flag expired timers
+ *
+ * Posts EVENT_TIMER when the earliest timer becomes due
+ *
+ * @param now current tick count
+ * @return void
+ */
+void swtimer_tick(ticktime now);
+
+/*
+ * @brief Prints the active timers with their period, run count and jitter
+ *
+ * @return void
+ */
+void swtimer_report(void);
+
+
+#endif /* SWTIMER_H_ */
@@ -11,26 +11,70 @@
 
 #include "MKL25Z4.h"
 #include "sysclock.h"
+#include "fsl_clock.h"
+#include "clock_config.h"
 
+// FLL output with DMX32=1 and DRS=0 is 732 times the 32.768 kHz reference
+#define FLL_24MHZ (732U * 32768U)
+
+static void fei_24mhz_init(void);
+static void pee_48mhz_init(void);
+
+static const sysclock_profile_t profiles[SYSCLOCK_NUM_PROFILES] =
+{
+  {"FEI 24 MHz", FLL_24MHZ, FLL_24MHZ / 2, FLL_24MHZ, fei_24mhz_init},
+  {"PEE 48 MHz", 48000000U, 24000000U, 48000000U, pee_48mhz_init},
+};
+
+static const sysclock_profile_t *current_profile = &profiles[SYSCLOCK_PROFILE];
+
+// FEI as shown in sec 24.4.1, the MCG walks there from whatever mode it is in
+static const mcg_config_t mcg_config_fei =
+{
+  .mcgMode = kMCG_ModeFEI,
+  .irclkEnableMode = kMCG_IrclkEnable,
+  .ircs = kMCG_IrcSlow,
+  .fcrdiv = 0x0U,
+  .frdiv = 0x0U,
+  .drs = kMCG_DrsLow,           // Select 24 MHz - see table for MCG_C4[DMX32]
+  .dmx32 = kMCG_Dmx32Fine,
+  .pll0Config = {.enableMode = 0U, .prdiv = 0x0U, .vdiv = 0x0U},
+};
+
+static const sim_clock_config_t sim_config_fei =
+{
+  .pllFllSel = 0U,              // UART0 and TPM clocked from MCGFLLCLK
+  .er32kSrc = 3U,               // LPO
+  .clkdiv1 = SIM_CLKDIV1_OUTDIV1(0) | SIM_CLKDIV1_OUTDIV4(1),   // Core /1, bus /2
+};
+
+
+static void fei_24mhz_init(void)
+{
+  CLOCK_SetSimSafeDivs();       // The core must not overclock while the MCG switches
+  CLOCK_SetMcgConfig(&mcg_config_fei);
+  CLOCK_SetSimConfig(&sim_config_fei);
+}
+
+static void pee_48mhz_init(void)
+{
+  // BOARD_InitBootClocks() normally leaves the MCG in PEE already
+  if (CLOCK_GetMode() != kMCG_ModePEE)
+  {
+    BOARD_BootClockRUN();
+  }
+}
 
 void sysclock_init()
 {
-  // Corresponds to FEI mode as shown in sec 24.4.1 
-
-  // Select PLL/FLL as clock source 
-  MCG->C1 &= ~(MCG_C1_CLKS_MASK);
-  MCG->C1 |= MCG_C1_CLKS(0);
-	
-  // Use internal reference clock as source for the FLL
-  MCG->C1 |= MCG_C1_IREFS(1);
-
-  // Select the FLL (by setting "PLL select" to 0)
-  MCG->C6 &= ~(MCG_C6_PLLS_MASK);
-  MCG->C6 |= MCG_C6_PLLS(0);
-
-  // Select 24 MHz - see table for MCG_C4[DMX32]
-  MCG->C4 &= ~(MCG_C4_DRST_DRS_MASK & MCG_C4_DMX32_MASK);
-  MCG->C4 |= MCG_C4_DRST_DRS(0);
-  MCG->C4 |= MCG_C4_DMX32(1);
+  current_profile = &profiles[SYSCLOCK_PROFILE];
+  current_profile->init();
+
+  // The timebase derives the systick reload from SystemCoreClock
+  SystemCoreClock = current_profile->core_hz;
 }
 
+const sysclock_profile_t *sysclock_profile(void)
+{
+  return current_profile;
+}
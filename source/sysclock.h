@@ -2,17 +2,51 @@
  * sysclock.h - configuration routines for KL25Z system clock
  * 
  * Author Howdy Pierce, howdy.pierce@colorado.edu
+ *
+ * The clock is set up from a profile descriptor. Every peripheral which depends on a
+ * clock frequency (UART baud rate, TPM period, I2C divider, systick reload) computes its
+ * setting from the descriptor of the selected profile, so changing the profile does not
+ * break any of them.
  */
 
 #ifndef _SYSCLOCK_H_
 #define _SYSCLOCK_H_
 
+#include <stdint.h>
+
+// Core clock assumed until sysclock_init() has run
 #define SYSCLOCK_FREQUENCY (24000000U)
 
+typedef enum
+{
+  SYSCLOCK_FEI_24MHZ = 0,       // FLL from the internal 32 kHz reference
+  SYSCLOCK_PEE_48MHZ,           // PLL from the 8 MHz crystal
+  SYSCLOCK_NUM_PROFILES
+} sysclock_profile_id_t;
+
+// Profile used by sysclock_init(), override from the build settings
+#if !defined(SYSCLOCK_PROFILE)
+#define SYSCLOCK_PROFILE SYSCLOCK_PEE_48MHZ
+#endif
+
+typedef struct
+{
+  const char *name;
+  uint32_t core_hz;             // Core, systick
+  uint32_t bus_hz;              // Bus and flash, clocks the I2C
+  uint32_t peripheral_hz;       // MCGFLLCLK or MCGPLLCLK/2 selected by PLLFLLSEL, clocks UART0 and the TPMs
+  void (*init)(void);           // Switches the MCG and sets the SIM dividers
+} sysclock_profile_t;
+
 /*
- * Initializes the system clock. You should call this first in your
- * program.
+ * Initializes the system clock with the SYSCLOCK_PROFILE profile. You should
+ * call this first in your program.
  */
 void sysclock_init();
 
+/*
+ * Returns the descriptor of the profile the clock is running from
+ */
+const sysclock_profile_t *sysclock_profile(void);
+
 #endif  // _SYSCLOCK_H_
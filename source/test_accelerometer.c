@@ -84,3 +84,29 @@ int test_accelerometer()
 
 	return result;
 }
+
+/*
+ * @brief Function to check the accelerometer with its electrical self-test, no tilting needed
+ *
+ * @return TRUE if the self-test passes, FALSE if not
+ */
+
+bool test_accelerometer_self_test()
+{
+	mma_self_test_t result;
+	printf("-----------Testing the accelerometer self-test-----------\n\r");
+	mma_self_test(&result);
+	if (result.who_am_i != MMA_WHO_AM_I_VALUE)
+	{
+		printf("WHO_AM_I is 0x%02X instead of 0x%02X / Error in fetching accelerometer through I2C bus\n\r",
+				result.who_am_i, MMA_WHO_AM_I_VALUE);
+	}
+	else
+	{
+		printf("Self-test output change X %ld, Y %ld, Z %ld (typical %d, %d, %d)\n\r", (long)result.delta[0],
+				(long)result.delta[1], (long)result.delta[2], MMA_ST_DELTA_X, MMA_ST_DELTA_Y, MMA_ST_DELTA_Z);
+		printf("Accelerometer self-test %s\n\r", result.passed ? "passed" : "failed");
+	}
+	printf("----------------------------------------------------------\n\r\n\r");
+	return result.passed;
+}
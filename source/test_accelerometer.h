@@ -9,6 +9,8 @@
 #ifndef TEST_ACCELEROMETER_H_
 #define TEST_ACCELEROMETER_H_
 
+#include <stdbool.h>
+
 
 
 /*
@@ -19,4 +21,12 @@
 
 int test_accelerometer();
 
+/*
+ * @brief Function to check the accelerometer with its electrical self-test, no tilting needed
+ *
+ * @return TRUE if the self-test passes, FALSE if not
+ */
+
+bool test_accelerometer_self_test();
+
 #endif /* TEST_ACCELEROMETER_H_ */
@@ -9,6 +9,7 @@
 #include "LEDs.h"
 #include <stdio.h>
 #include "timer.h"
+#include "swtimer.h"
 
 #define RED   0xFF
 #define BLUE  0xFF
@@ -19,6 +20,42 @@
 #define TWO_SECOND 2000
 #define PASS 1
 
+typedef struct
+{
+	uint16_t red;
+	uint16_t green;
+	uint16_t blue;
+} led_step_t;
+
+static const led_step_t led_sequence[] = {{RED, OFF, OFF},		/*Turning On red, blue, greem for 1 second*/
+										  {OFF, BLUE, OFF},
+										  {OFF, OFF, GREEN},
+										  {RED, BLUE, GREEN},	/*Combination of Red, Blue, Green colour at the same time*/
+										  {OFF, OFF, OFF}};
+
+static const int num_led_steps = sizeof(led_sequence) / sizeof(led_step_t);
+
+static swtimer_t led_test_timer;
+static int led_step = 0;
+
+
+/*
+ * @brief Periodic timer callback which shows the next colour of the test sequence
+ *
+ * @param arg unused
+ * @return void
+ */
+static void led_test_step(void *arg)
+{
+	if (led_step == num_led_steps)
+	{
+		swtimer_stop(&led_test_timer);				/*Last colour was shown for one second*/
+		return;
+	}
+	update_led_colour(led_sequence[led_step].red, led_sequence[led_step].green, led_sequence[led_step].blue);
+	led_step++;
+}
+
 
 /*
  * @brief Function to check whether the led's are working or not
@@ -31,16 +68,13 @@ int test_leds()
 	delay(TWO_SECOND);
 	printf("----------------------Testing Leds-----------------------\n\r");
 	printf("---Blinking RED, BLUE, GREEN, WHITE LED for one second---\n\r");
-	update_led_colour(RED, OFF, OFF);				/*Turning On red, blue, greem for 1 second*/
-	delay(ONE_SECOND);
-	update_led_colour(OFF, BLUE, OFF);
-	delay(ONE_SECOND);
-	update_led_colour(OFF, OFF, GREEN);
-	delay(ONE_SECOND);
-	update_led_colour(RED, BLUE, GREEN);
-	delay(ONE_SECOND);
-	update_led_colour(OFF, OFF, OFF);				/*Combination of Red, Blue, Green colour at the same time*/
-	delay(ONE_SECOND);
+	led_step = 0;
+	led_test_step(NULL);							/*First colour immediately, then one per second*/
+	swtimer_periodic(&led_test_timer, "led test", ONE_SECOND, led_test_step, NULL);
+	while (led_test_timer.active)
+	{
+		swtimer_service();
+	}
 	printf("----------All the led colours are blinking properly-------\n\r");
 	printf("----------------------------------------------------------\n\r\n\r");
 	return PASS;
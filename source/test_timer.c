@@ -0,0 +1,99 @@
+/**
+ * @file    test_timer.c
+ * @brief   This source file consists of function definition to test the timebase and the
+ * 			software timer service
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ */
+
+#include <stdio.h>
+#include "test_timer.h"
+#include "timer.h"
+#include "swtimer.h"
+
+#define PASS 1
+#define FAIL 0
+
+#define MONOTONIC_READS   1000
+#define DELAY_MSEC        10
+#define DELAY_MAX_US      ((DELAY_MSEC + 2) * 1000)	/*delay() waits up to one extra tick*/
+#define ONESHOT_MSEC      20
+#define PERIOD_MSEC       5
+#define TEST_WINDOW_MSEC  52						/*Long enough for 10 periods, too short for 11*/
+#define EXPECTED_PERIODS  10
+
+
+/*
+ * @brief Timer callback counting its runs
+ *
+ * @param arg the counter to increment
+ * @return void
+ */
+static void count_runs(void *arg)
+{
+	(*(int *)arg)++;
+}
+
+/*
+ * @brief Function to check whether the timebase and software timers work or not
+ *
+ * @return TRUE if timers work, FALSE if not works
+ */
+bool test_timer()
+{
+	int result = PASS;
+	swtimer_t oneshot;
+	swtimer_t periodic;
+	int oneshot_runs = 0;
+	int periodic_runs = 0;
+	uint64_t previous;
+	uint64_t current;
+	uint32_t start_us;
+	uint32_t elapsed_us;
+
+	printf("-------------Testing timebase and software timers--------\n\r");
+
+	previous = timebase_cycles64();
+	for (int i = 0; i < MONOTONIC_READS; i++)		/*Time must never go backwards across tick wraps*/
+	{
+		current = timebase_cycles64();
+		if (current < previous)
+		{
+			printf("Timebase went backwards\n\r");
+			result = FAIL;
+			break;
+		}
+		previous = current;
+	}
+
+	start_us = timebase_us();
+	delay(DELAY_MSEC);
+	elapsed_us = timebase_us() - start_us;
+	if ((elapsed_us < (DELAY_MSEC * 1000)) || (elapsed_us > DELAY_MAX_US))
+	{
+		printf("delay(%d) took %lu us\n\r", DELAY_MSEC, (unsigned long)elapsed_us);
+		result = FAIL;
+	}
+
+	oneshot.active = false;
+	periodic.active = false;
+	swtimer_oneshot(&oneshot, "test oneshot", ONESHOT_MSEC, count_runs, &oneshot_runs);
+	swtimer_periodic(&periodic, "test periodic", PERIOD_MSEC, count_runs, &periodic_runs);
+	delay(TEST_WINDOW_MSEC);						/*Timers are serviced from delay()*/
+	swtimer_stop(&periodic);
+	swtimer_stop(&oneshot);
+
+	if ((oneshot_runs != 1) || (periodic_runs != EXPECTED_PERIODS))
+	{
+		printf("One-shot ran %d times, periodic ran %d times\n\r", oneshot_runs, periodic_runs);
+		result = FAIL;
+	}
+
+	if (result == PASS)
+	{
+		printf("Timebase and software timers are working properly\n\r");
+	}
+	printf("----------------------------------------------------------\n\r\n\r");
+	return result;
+}
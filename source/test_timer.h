@@ -0,0 +1,23 @@
+/**
+ * @file    test_timer.h
+ * @brief   This header file consists of function prototype to test the timebase and the
+ * 			software timer service
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ */
+
+#ifndef TEST_TIMER_H_
+#define TEST_TIMER_H_
+
+#include <stdbool.h>
+
+
+/*
+ * @brief Function to check whether the timebase and software timers work or not
+ *
+ * @return TRUE if timers work, FALSE if not works
+ */
+bool test_timer();
+
+#endif /* TEST_TIMER_H_ */
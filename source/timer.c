@@ -15,45 +15,204 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include "timer.h"
+#include "sysclock.h"
+#include "swtimer.h"
+#include "idle.h"
+#include "critical.h"
+#include "irqstat.h"
+#include "switch.h"
 #include "MKL25Z4.h"
 
 
-#define SYSTICK_LOAD_VALUE  11000			/*A 24 Mhz clock to tick every 1 msec requires to be loaded with 11000*/
-#define SYSTICK_MASK_VALUE  0x7
+#define SYSTICK_MASK_VALUE  0x7				/*Core clock as source, tick interrupt and counter enabled*/
+#define MICROSECONDS_PER_TICK (1000 * TICK_PERIOD_MS)
 
-volatile ticktime ticksCount=0; /*Incremented every 62.5 ms in interrupt handler*/
+volatile ticktime ticksCount=0; /*Incremented every 1 ms in interrupt handler*/
+volatile uint32_t ticksHigh=0;  /*Upper 32 bits of the 64 bit tick count, incremented when ticksCount wraps*/
 ticktime reset_time=0; /*Used the get the current time value from a previous Value by subtracting it */
 
+static uint32_t cycles_per_tick = SYSCLOCK_FREQUENCY / TICKS_PER_SECOND;	/*Systick reload period in core cycles*/
+
 
 /*
- *@brief Initializes the systick to generate a tick every 62.5 ms
+ *@brief Initializes the systick to generate a tick every 1 ms
  *
- *The clock is set as external clock and timer is incremented very 62.5ms and the NVIC
- *priority is set as 3
+ *The systick is clocked from the core clock and the reload value is derived from
+ *SystemCoreClock, so a tick is 1 ms whatever the core frequency. The NVIC
+ *priority is set as 2, above the PendSV bottom halves
  *
  *@return void
  */
 void Init_SysTick(void)
 {
-  	SysTick->LOAD = SYSTICK_LOAD_VALUE;
-  	NVIC_SetPriority(SysTick_IRQn,3);
+	cycles_per_tick = SystemCoreClock / TICKS_PER_SECOND;
+  	SysTick->LOAD = cycles_per_tick - 1;		/*Counter runs from LOAD down to 0, so the period is LOAD+1 cycles*/
+  	NVIC_SetPriority(SysTick_IRQn,2);
   	SysTick->VAL=0;
   	SysTick->CTRL= SYSTICK_MASK_VALUE ;
-  	//SysTick->CTRL=SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk ;
 
 }
 
 /*
- *@brief The interrupt handler when the interrupt is triggered for 62.5 ms
+ *@brief The interrupt handler when the interrupt is triggered every 1 ms
  *
- *Ticks variable is incremented, a flag is set to 1 when 1 ms is reached
+ *Ticks variable is incremented and carried in to the upper word on wrap, and the
+ *software timers are checked for expiry and the CPU load window is closed every second
  *
  *@return void
  */
 void SysTick_Handler()
 {
-   ticksCount++;
+	IRQ_STAT_ENTER(IRQ_LATENCY_SYSTICK);
+	ticksCount++;
+	if (ticksCount == 0)
+	{
+		ticksHigh++;
+	}
+	swtimer_tick(ticksCount);
+	cpu_load_tick(ticksCount);
+	switch_tick(ticksCount);
+	IRQ_STAT_EXIT(IRQ_STAT_SYSTICK);
+}
+
+/*
+ *@brief Takes a consistent snapshot of the 64 bit tick count and the cycles elapsed
+ *		 within the current tick
+ *
+ *If the systick has wrapped but its interrupt is still pending (interrupts masked or a
+ *higher priority handler running) the pending tick is accounted here, so the time never
+ *goes backwards
+ *
+ *@param1 ticks_high upper word of the tick count
+ *@param2 ticks_low lower word of the tick count
+ *@return cycles elapsed since the start of the current tick
+ */
+static uint32_t timebase_snapshot(uint32_t *ticks_high, uint32_t *ticks_low)
+{
+	crit_state_t masking_state = crit_enter(CRIT_TIMEBASE);
+	uint32_t low = ticksCount;
+	uint32_t high = ticksHigh;
+	uint32_t value = SysTick->VAL;
+	if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)		/*Wrap happened, re-read the counter after the reload*/
+	{
+		value = SysTick->VAL;
+		low++;
+		if (low == 0)
+		{
+			high++;
+		}
+	}
+	crit_exit(CRIT_TIMEBASE, masking_state);
+	*ticks_high = high;
+	*ticks_low = low;
+	return (cycles_per_tick - 1) - value;
+}
+
+/*
+ *@brief Number of 1 ms ticks since Init_SysTick(), wraps after ~49 days
+ *
+ *@return tick count
+ */
+ticktime timebase_ticks(void)
+{
+	return ticksCount;
+}
+
+/*
+ *@brief Tick count and the cycles elapsed within the tick, from one snapshot
+ *
+ *@param ticks set to the tick count, wraps after ~49 days
+ *@return core clock cycles since the start of that tick
+ */
+uint32_t timebase_tick_cycles(ticktime *ticks)
+{
+	uint32_t high;
+	return timebase_snapshot(&high, ticks);
+}
+
+/*
+ *@brief Core clock cycles since Init_SysTick(), extended to 64 bits
+ *
+ *@return cycles since startup
+ */
+uint64_t timebase_cycles64(void)
+{
+	uint32_t high, low;
+	uint32_t elapsed = timebase_snapshot(&high, &low);
+	return ((((uint64_t)high << 32) | low) * cycles_per_tick) + elapsed;
+}
+
+/*
+ *@brief Lower 32 bits of timebase_cycles64()
+ *
+ *@return cycles since startup modulo 2^32
+ */
+uint32_t timebase_cycles(void)
+{
+	uint32_t high, low;
+	uint32_t elapsed = timebase_snapshot(&high, &low);
+	return (low * cycles_per_tick) + elapsed;
+}
+
+/*
+ *@brief Microseconds since Init_SysTick(), extended to 64 bits
+ *
+ *@return microseconds since startup
+ */
+uint64_t timebase_us64(void)
+{
+	uint32_t high, low;
+	uint32_t elapsed = timebase_snapshot(&high, &low);
+	return ((((uint64_t)high << 32) | low) * MICROSECONDS_PER_TICK) + ((elapsed * MICROSECONDS_PER_TICK) / cycles_per_tick);
+}
+
+/*
+ *@brief Lower 32 bits of timebase_us64(), wraps after ~71 minutes
+ *
+ *@return microseconds since startup modulo 2^32
+ */
+uint32_t timebase_us(void)
+{
+	uint32_t high, low;
+	uint32_t elapsed = timebase_snapshot(&high, &low);
+	return (low * MICROSECONDS_PER_TICK) + ((elapsed * MICROSECONDS_PER_TICK) / cycles_per_tick);
+}
+
+/*
+ *@brief Converts a cycle count as returned by the timebase into microseconds
+ *
+ *Whole ticks and the remainder are converted apart, so the exact cycles per tick is
+ *used without a 64 bit division and the product never overflows
+ *
+ *@param cycles core clock cycles
+ *@return microseconds
+ */
+uint32_t timebase_cycles_to_us(uint32_t cycles)
+{
+	return ((cycles / cycles_per_tick) * MICROSECONDS_PER_TICK) +
+			(((cycles % cycles_per_tick) * MICROSECONDS_PER_TICK) / cycles_per_tick);
+}
+
+/*
+ *@brief Converts a 64 bit cycle count as returned by timebase_cycles64() into microseconds
+ *
+ *@param cycles core clock cycles
+ *@return microseconds
+ */
+uint64_t timebase_cycles64_to_us(uint64_t cycles)
+{
+	return ((cycles / cycles_per_tick) * MICROSECONDS_PER_TICK) +
+			(((uint32_t)(cycles % cycles_per_tick) * MICROSECONDS_PER_TICK) / cycles_per_tick);
+}
 
+/*
+ *@brief Core clock cycles per tick used by the timebase, SystemCoreClock / TICKS_PER_SECOND
+ *
+ *@return cycles per tick
+ */
+uint32_t timebase_cycles_per_tick(void)
+{
+	return cycles_per_tick;
 }
 
 /*
@@ -72,7 +231,7 @@ static ticktime current_time()
  *@brief Calculate the number of ticks since startup, used in functions reset_timer()
  *and get_timer() to calculate number of ticks at various intervals
  *
- *@return ticks since program startup to the calling function where every tick is 62.5 ms
+ *@return ticks since program startup to the calling function where every tick is 1 ms
  */
 static ticktime now()
 {
@@ -97,7 +256,7 @@ void reset_timer()
  *		 to calculate the current time by subtracting the reset_time with now time
  *
  *
- *@return the current time in ticks  to the calling function where every tick is 62.5 ms
+ *@return the current time in ticks  to the calling function where every tick is 1 ms
  */
 ticktime get_timer()
 {
@@ -109,6 +268,8 @@ ticktime get_timer()
 /*
  *@brief This function is used to calculate a delay of required msec
  *
+ *Expired software timers keep running while waiting and the core sleeps between ticks
+ *
  *@param the msec delay required
  */
 void delay(uint32_t delay_msec)
@@ -117,7 +278,8 @@ void delay(uint32_t delay_msec)
   ticktime current_tick = now();
   while ((now() - current_tick) <= delay_msec) 		/*while loop executed till the time is reached*/
   {
-	  __asm volatile("NOP");
+	  swtimer_service();
+	  idle_wait();
   }
  }
 
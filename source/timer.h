@@ -2,6 +2,7 @@
  * @file    timer.h
  * @brief   This header file consists of function prototypes to configure the systick module
  	 	 	systick interrupt and timer functions, used to calculate time in state machine
+ 	 	 	and the microsecond/cycle resolution timebase built on top of it
  * @date 	10th October, 2021
  * @author 	Shreyan Prabhu
  * @Tools   MCU Expresso IDE, KL25Z Freedom development board
@@ -22,6 +23,9 @@
 
 typedef uint32_t ticktime;
 
+#define TICK_PERIOD_MS   (1)				/*Every systick tick is exactly 1 msec*/
+#define TICKS_PER_SECOND (1000 / TICK_PERIOD_MS)
+
 
 /*
  *@brief This function is used to calculate a delay of required msec
@@ -31,10 +35,11 @@ typedef uint32_t ticktime;
 void delay(uint32_t delay_msec);
 
 /*
- *@brief Initializes the systick to generate a tick every 62.5 ms
+ *@brief Initializes the systick to generate a tick every 1 ms
  *
- *The clock is set as external clock and timer is incremented very 62.5ms and the NVIC
- *priority is set as 3
+ *The systick is clocked from the core clock and the reload value is derived from
+ *SystemCoreClock, so a tick is 1 ms whatever the core frequency. The NVIC
+ *priority is set as 2, above the PendSV bottom halves
  *
  *@return void
  */
@@ -56,15 +61,95 @@ void reset_timer();
  *		 to calculate the current time by subtracting the reset_time with now() time
  *
  *
- *@return the current time in ticks  to the calling function where every tick is 62.5 ms
+ *@return the current time in ticks  to the calling function where every tick is 1 ms
  */
 ticktime get_timer();
 
 
+/*
+ *@brief Number of 1 ms ticks since Init_SysTick(), wraps after ~49 days
+ *
+ *@return tick count
+ */
+ticktime timebase_ticks(void);
 
-#endif /* TIMER_H_ */
+/*
+ *@brief Tick count and the cycles elapsed within the tick, from one snapshot
+ *
+ *A timestamp which spans as long as the tick count without any division, for
+ *records kept much longer than the 32 bit cycle count wraps
+ *
+ *@param ticks set to the tick count, wraps after ~49 days
+ *@return core clock cycles since the start of that tick
+ */
+uint32_t timebase_tick_cycles(ticktime *ticks);
+
+/*
+ *@brief Core clock cycles since Init_SysTick(), extended to 64 bits
+ *
+ *Combines the tick counter with SysTick->VAL, so the resolution is one core clock.
+ *Safe to call from interrupt handlers and with interrupts masked.
+ *
+ *@return cycles since startup
+ */
+uint64_t timebase_cycles64(void);
 
+/*
+ *@brief Lower 32 bits of timebase_cycles64()
+ *
+ *Cheapest timestamp for measuring short intervals: the difference of two readings
+ *taken with unsigned arithmetic is correct across the 32 bit wrap (~178 s at 24 MHz)
+ *
+ *@return cycles since startup modulo 2^32
+ */
+uint32_t timebase_cycles(void);
 
+/*
+ *@brief Microseconds since Init_SysTick(), extended to 64 bits
+ *
+ *The cycles within the current tick are scaled by the exact cycles per tick, so they
+ *never add up to a whole tick and the time is monotonic at any core clock
+ *
+ *@return microseconds since startup
+ */
+uint64_t timebase_us64(void);
+
+/*
+ *@brief Lower 32 bits of timebase_us64(), wraps after ~71 minutes
+ *
+ *@return microseconds since startup modulo 2^32
+ */
+uint32_t timebase_us(void);
+
+/*
+ *@brief Converts a cycle count as returned by the timebase into microseconds
+ *
+ *Scaled by the exact cycles per tick, not a truncated cycles per microsecond, so the
+ *result agrees with timebase_us() at any core clock
+ *
+ *@param cycles core clock cycles
+ *@return microseconds
+ */
+uint32_t timebase_cycles_to_us(uint32_t cycles);
+
+/*
+ *@brief Converts a 64 bit cycle count as returned by timebase_cycles64() into microseconds
+ *
+ *@param cycles core clock cycles
+ *@return microseconds
+ */
+uint64_t timebase_cycles64_to_us(uint64_t cycles);
+
+/*
+ *@brief Core clock cycles per tick used by the timebase, SystemCoreClock / TICKS_PER_SECOND
+ *
+ *@return cycles per tick
+ */
+uint32_t timebase_cycles_per_tick(void);
+
+
+
+#endif /* TIMER_H_ */
 
 
 
@@ -0,0 +1,250 @@
+/**
+ * @file    trace.c
+ * @brief   This source file consists of function definitions of the instruction trace, which
+ * 			records the branches taken by the core in the Micro Trace Buffer (MTB)
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ * @References
+ * 1) KL25 Sub-Family Reference Manual, Micro Trace Buffer (MTB) chapter
+ * 2) ARM CoreSight MTB-M0+ Technical Reference Manual
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "MKL25Z4.h"
+#include "trace.h"
+#include "uart.h"
+
+#if TRACE_ENABLE
+
+extern unsigned char __mtb_buffer__[];			/*Reserved by mtb.c, aligned to its size*/
+
+static uint32_t window = __MTB_BUFFER_SIZE;
+static const char *armed_region = NULL;			/*Region trace_begin() starts on*/
+static const char *traced_region = NULL;		/*Region being traced, stopped by trace_end()*/
+static bool running = false;
+static bool captured = false;					/*The buffer holds a trace*/
+
+
+/*
+ * @brief Offset of the buffer from the start of the SRAM, as used by the MTB position register
+ *
+ * @return offset in bytes
+ */
+static uint32_t buffer_offset(void)
+{
+	return (uint32_t)__mtb_buffer__ - MTB->BASE;
+}
+
+/*
+ * @brief Number of packets captured and the one to send first
+ *
+ * @param1 first set to the index of the oldest packet
+ * @param2 wrapped set to true if older packets were overwritten
+ * @return number of packets in the buffer
+ */
+static uint32_t captured_packets(uint32_t *first, bool *wrapped)
+{
+	uint32_t position = MTB->POSITION;
+	uint32_t next = ((position & MTB_POSITION_POINTER_MASK) - buffer_offset()) & (window - 1);
+
+	*first = 0;
+	*wrapped = captured && ((position & MTB_POSITION_WRAP_MASK) != 0);
+	if (!captured)
+	{
+		return 0;
+	}
+	if (*wrapped)								/*The oldest packet is the next one to be written*/
+	{
+		*first = next / TRACE_PACKET_SIZE;
+		return window / TRACE_PACKET_SIZE;
+	}
+	return next / TRACE_PACKET_SIZE;
+}
+
+/*
+ * @brief Sets how much of the reserved buffer the trace uses, takes effect on the next start
+ *
+ * @param bytes window size, a power of 2 from TRACE_MIN_WINDOW up to __MTB_BUFFER_SIZE
+ * @return true if the size is valid
+ */
+bool trace_set_window(uint32_t bytes)
+{
+	if ((bytes < TRACE_MIN_WINDOW) || (bytes > __MTB_BUFFER_SIZE) || ((bytes & (bytes - 1)) != 0))
+	{
+		return false;
+	}
+	window = bytes;
+	return true;
+}
+
+/*
+ * @brief Starts tracing in to an empty buffer
+ *
+ * @return void
+ */
+void trace_start(void)
+{
+	uint32_t mask = 0;
+	while ((TRACE_MIN_WINDOW << mask) < window)
+	{
+		mask++;									/*The buffer wraps at 2^(MASK+4) bytes*/
+	}
+	MTB->MASTER &= ~MTB_MASTER_EN_MASK;
+	MTB->POSITION = buffer_offset() & MTB_POSITION_POINTER_MASK;	/*Also clears the wrap flag*/
+	MTB->FLOW = 0;								/*No watermark, keep the latest branches*/
+	running = true;
+	captured = true;
+	MTB->MASTER = MTB_MASTER_MASK(mask) | MTB_MASTER_EN_MASK;		/*Last, so the set up is not traced*/
+}
+
+/*
+ * @brief Stops tracing, the buffer is kept until the next start
+ *
+ * @return void
+ */
+void trace_stop(void)
+{
+	MTB->MASTER &= ~MTB_MASTER_EN_MASK;			/*First, so the rest is not traced*/
+	running = false;
+	traced_region = NULL;
+}
+
+/*
+ * @brief Arms the trace to capture the next region with this name
+ *
+ * @param region name passed to trace_begin() and trace_end(), NULL to disarm
+ * @return void
+ */
+void trace_arm(const char *region)
+{
+	armed_region = region;
+}
+
+/*
+ * @brief Starts tracing if the trace is armed for this region
+ *
+ * @param region name of the region
+ * @return void
+ */
+void trace_begin(const char *region)
+{
+	if ((armed_region == NULL) || (strcmp(armed_region, region) != 0))
+	{
+		return;
+	}
+	armed_region = NULL;
+	traced_region = region;
+	trace_start();
+}
+
+/*
+ * @brief Stops tracing and disarms if the trace was started for this region
+ *
+ * @param region name of the region
+ * @return void
+ */
+void trace_end(const char *region)
+{
+	if (running && (traced_region == region))
+	{
+		trace_stop();
+		printf("Traced one %s step, type trace dump to read it\n\r", region);
+	}
+}
+
+/*
+ * @brief Stops tracing and sends the packets, oldest first, as a text line followed by
+ * the raw packets
+ *
+ * @return void
+ */
+void trace_dump(void)
+{
+	uint32_t first;
+	uint32_t count;
+	bool wrapped;
+
+	trace_stop();
+	count = captured_packets(&first, &wrapped);
+	printf("MTB %lu %u\n\r", (unsigned long)count, wrapped ? 1 : 0);
+	uart0_write(&__mtb_buffer__[first * TRACE_PACKET_SIZE], (count - first) * TRACE_PACKET_SIZE);
+	uart0_write(__mtb_buffer__, first * TRACE_PACKET_SIZE);		/*The part before the wrap point*/
+	printf("\n\rMTB END\n\r");
+}
+
+/*
+ * @brief Prints the state of the trace and the number of packets captured
+ *
+ * @return void
+ */
+void trace_report(void)
+{
+	uint32_t first;
+	bool wrapped;
+	uint32_t count = captured_packets(&first, &wrapped);
+
+	printf("Trace %s, window %lu of the %lu bytes at 0x%08lx, %lu branches captured%s\n\r",
+			running ? "running" : "stopped", (unsigned long)window, (unsigned long)__MTB_BUFFER_SIZE,
+			(unsigned long)__mtb_buffer__, (unsigned long)count, wrapped ? " (wrapped, older ones lost)" : "");
+	if (armed_region != NULL)
+	{
+		printf("Armed for the next %s step\n\r", armed_region);
+	}
+}
+
+#else
+
+/*
+ * @brief Sets how much of the reserved buffer the trace uses, takes effect on the next start
+ *
+ * @param bytes window size
+ * @return false, there is no trace buffer
+ */
+bool trace_set_window(uint32_t bytes)
+{
+	return false;
+}
+
+void trace_start(void)
+{
+}
+
+void trace_stop(void)
+{
+}
+
+void trace_arm(const char *region)
+{
+}
+
+void trace_begin(const char *region)
+{
+}
+
+void trace_end(const char *region)
+{
+}
+
+/*
+ * @brief Stops tracing and sends the packets
+ *
+ * @return void
+ */
+void trace_dump(void)
+{
+	printf("MTB trace is not enabled in this build\n\r");
+}
+
+/*
+ * @brief Prints the state of the trace
+ *
+ * @return void
+ */
+void trace_report(void)
+{
+	printf("MTB trace is not enabled in this build\n\r");
+}
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * @file    trace.h
+ * @brief   This header file consists of function prototypes of the instruction trace, which
+ * 			records the branches taken by the core in the Micro Trace Buffer (MTB)
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   MCU Expresso IDE, KL25Z Freedom development board
+ *
+ * While tracing, the MTB writes an 8 byte packet to the buffer reserved by mtb.c for every
+ * taken branch, exception entry and exception return: the address branched from and the
+ * address branched to. The buffer wraps, keeping the latest branches. Tracing is started
+ * and stopped from the console, by hand or around one step of a long-running command, and
+ * tools/mtbdecode.py turns the output of the trace dump command back in to function names
+ * using the ELF file.
+ *
+ * __MTB_BUFFER_SIZE sets the buffer reserved in RAM, a power of 2 aligned to its size; the
+ * trace can use a smaller window of it. Define __MTB_DISABLE or set the size to 0 to build
+ * without the trace. A debugger using the MTB takes it over while connected.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#if !defined(__MTB_BUFFER_SIZE)
+#define __MTB_BUFFER_SIZE 512					/*64 branches*/
+#endif
+
+#if !defined(__MTB_DISABLE) && (__MTB_BUFFER_SIZE > 0)
+#define TRACE_ENABLE 1
+#else
+#define TRACE_ENABLE 0
+#endif
+
+#define TRACE_PACKET_SIZE 8
+#define TRACE_MIN_WINDOW 16U						/*Smallest wrap size of the MTB*/
+
+/*
+ * @brief Sets how much of the reserved buffer the trace uses, takes effect on the next start
+ *
+ * @param bytes window size, a power of 2 from TRACE_MIN_WINDOW up to __MTB_BUFFER_SIZE
+ * @return true if the size is valid
+ */
+bool trace_set_window(uint32_t bytes);
+
+/*
+ * @brief Starts tracing in to an empty buffer
+ *
+ * @return void
+ */
+void trace_start(void);
+
+/*
+ * @brief Stops tracing, the buffer is kept until the next start
+ *
+ * @return void
+ */
+void trace_stop(void);
+
+/*
+ * @brief Arms the trace to capture the next region with this name
+ *
+ * @param region name passed to trace_begin() and trace_end(), NULL to disarm
+ * @return void
+ */
+void trace_arm(const char *region);
+
+/*
+ * @brief Starts tracing if the trace is armed for this region
+ *
+ * @param region name of the region
+ * @return void
+ */
+void trace_begin(const char *region);
+
+/*
+ * @brief Stops tracing and disarms if the trace was started for this region
+ *
+ * @param region name of the region
+ * @return void
+ */
+void trace_end(const char *region);
+
+/*
+ * @brief Stops tracing and sends the packets, oldest first, as a text line followed by
+ * the raw packets
+ *
+ * @return void
+ */
+void trace_dump(void);
+
+/*
+ * @brief Prints the state of the trace and the number of packets captured
+ *
+ * @return void
+ */
+void trace_report(void);
+
+
+#endif /* TRACE_H_ */
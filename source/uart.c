@@ -15,10 +15,16 @@
 #include "UART.h"
 #include <stdio.h>
 #include "queue.h"
+#include "profiler.h"
+#include "idle.h"
+#include "events.h"
+#include "sysclock.h"
+#include "ramfunc.h"
+#include "irqstat.h"
+#include "probe.h"
 
 #define UART_OVERSAMPLE_RATE 	(16)
-#define BUS_CLOCK 				(24e6)
-#define SYS_CLOCK				(24e6)
+#define UART_WRITE_PIECE		(MAX_SIZE / 2)	/*Bytes handed to the transmit queue at once*/
 
 #define BAUD_RATE    	38400
 #define DATA_BIT_MODE		0		/*0 for 8 bit mode and 1 for 9 bit mode*/
@@ -43,14 +49,15 @@ void init_uart0()
 	SIM->SCGC5 |= SIM_SCGC5_PORTA_MASK;
 
 	UART0->C2 &= ~UART0_C2_TE_MASK & ~UART0_C2_RE_MASK;
-	SIM->SOPT2 |= SIM_SOPT2_UART0SRC(1);				  /* Set UART clock to 48 MHz clock */
+	SIM->SOPT2 |= SIM_SOPT2_UART0SRC(1);				  /* Clock UART0 from the PLL/FLL peripheral clock */
 
 
 	PORTA->PCR[1] = PORT_PCR_ISF_MASK | PORT_PCR_MUX(2);  /* Set pins to UART0 Rx */
 	PORTA->PCR[2] = PORT_PCR_ISF_MASK | PORT_PCR_MUX(2);  /* Set pins to UART0 Tx */
 
 
-	sbr = (uint16_t)((SYS_CLOCK)/(BAUD_RATE * UART_OVERSAMPLE_RATE));	/* Set baud rate and oversampling ratio */
+	uint32_t divisor = BAUD_RATE * UART_OVERSAMPLE_RATE;
+	sbr = (uint16_t)((sysclock_profile()->peripheral_hz + divisor/2) / divisor);	/* Set baud rate and oversampling ratio, rounded */
 	UART0->BDH &= ~UART0_BDH_SBR_MASK;
 	UART0->BDH |= UART0_BDH_SBR(sbr>>8);
 	UART0->BDL = UART0_BDL_SBR(sbr);
@@ -66,7 +73,7 @@ void init_uart0()
 
 		UART0->S2 = UART0_S2_MSBF(0) | UART0_S2_RXINV(0);
 
-	NVIC_SetPriority(UART0_IRQn, 2); 		/*Setting interrupt priority to 2*/
+	NVIC_SetPriority(UART0_IRQn, 1); 		/*Setting interrupt priority to 1, above the other top halves as there is no receive FIFO*/
 	NVIC_ClearPendingIRQ(UART0_IRQn);
 	NVIC_EnableIRQ(UART0_IRQn);
 
@@ -84,8 +91,10 @@ void init_uart0()
 * @param none
 * @return none
 */
-void UART0_IRQHandler(void)
+RAMFUNC void UART0_IRQHandler(void)
 {
+	IRQ_STAT_ENTER(IRQ_LATENCY_UNKNOWN);						/*The flags do not record when they were set*/
+	PROBE_ISR_HIGH(PROBE_UART_ISR);
 	uint8_t inputCharacter;
 	if (UART0->S1 & (UART_S1_OR_MASK |UART_S1_NF_MASK |
 		UART_S1_FE_MASK | UART_S1_PF_MASK))
@@ -98,6 +107,7 @@ void UART0_IRQHandler(void)
 	{
 		inputCharacter = UART0->D;									/* receive a character */
 	    Q_Enqueue(&RxQ, &inputCharacter, 1);
+	    event_post(EVENT_UART_RX);								/*The console echoes and parses from the main loop*/
 
 	}
 	if ( (UART0->C2 & UART0_C2_TIE_MASK) && 						/* transmitter interrupt enabled */
@@ -113,6 +123,8 @@ void UART0_IRQHandler(void)
 			UART0->C2 &= ~UART0_C2_TIE_MASK;						/* Disable transmitter interrupt since queue is empty */
 		}
 	}
+	PROBE_ISR_LOW(PROBE_UART_ISR);
+	IRQ_STAT_EXIT(IRQ_STAT_UART0);
 }
 
 /**
@@ -124,12 +136,17 @@ void UART0_IRQHandler(void)
 */
 int __sys_write(int handle, char *buf, int size)
 {
-	while(Q_Size(&TxQ)!=0);
+	PROF_BEGIN(PROF_SYS_WRITE);
+	while(Q_Size(&TxQ)!=0)
+	{
+		idle_wait();									/*Woken by the transmit interrupt*/
+	}
 	Q_Enqueue(&TxQ,buf,size);
 	if(!(UART0->C2 & UART_C2_TIE_MASK))
 	{
 		UART0->C2 |= UART0_C2_TIE(1);
 	}
+	PROF_END(PROF_SYS_WRITE);
 	return 0;
 
 }
@@ -145,8 +162,77 @@ int __sys_readc(void)
 
 	while(a==0)
 	{
-		Q_Dequeue(&RxQ, &a ,1);
+		if (Q_Dequeue(&RxQ, &a ,1) == 0)
+		{
+			idle_wait();								/*Woken by the receive interrupt or the systick*/
+		}
 	}
 	return a;
 }
 
+
+/**
+* @brief Transmits a block of binary data, waiting for room in the transmit queue
+*
+* Written in pieces which fit the transmit queue, a longer enqueue would be truncated
+*
+* @param1 data bytes to send
+* @param2 size number of bytes
+* @return none
+*/
+void uart0_write(const void *data, uint32_t size)
+{
+	const char *bytes = (const char *)data;
+	while (size > 0)
+	{
+		uint32_t piece = (size < UART_WRITE_PIECE) ? size : UART_WRITE_PIECE;
+		__sys_write(1, (char *)bytes, piece);
+		bytes += piece;
+		size -= piece;
+	}
+}
+
+/**
+* @brief Appends text to the transmit queue, waiting only while the queue is full
+*
+* Unlike __sys_write the queue does not have to drain first. The transmit interrupt,
+* the only other user of the queue, is masked while the bytes are enqueued
+*
+* @param1 text bytes to send
+* @param2 size number of bytes
+* @return none
+*/
+void uart0_put(const char *text, uint32_t size)
+{
+	while (size > 0)
+	{
+		UART0->C2 &= ~UART0_C2_TIE_MASK;
+		int count = Q_Enqueue(&TxQ, (void *)text, size);
+		UART0->C2 |= UART0_C2_TIE(1);
+		if (count > 0)
+		{
+			text += count;
+			size -= count;
+		}
+		if (size > 0)
+		{
+			idle_wait();								/*Woken by the transmit interrupt*/
+		}
+	}
+}
+
+/**
+* @brief Takes a character from the receive queue without waiting
+*
+* @return the character, or -1 if nothing has been received
+*/
+int uart0_try_getchar(void)
+{
+	char a;
+
+	if (Q_Dequeue(&RxQ, &a ,1) == 0)
+	{
+		return -1;
+	}
+	return (unsigned char)a;
+}
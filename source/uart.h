@@ -23,6 +23,31 @@
 
 void init_uart0();
 
+/**
+* @brief Takes a character from the receive queue without waiting
+*
+* @return the character, or -1 if nothing has been received
+*/
+int uart0_try_getchar(void);
+
+/**
+* @brief Transmits a block of binary data, waiting for room in the transmit queue
+*
+* @param1 data bytes to send
+* @param2 size number of bytes
+* @return none
+*/
+void uart0_write(const void *data, uint32_t size);
+
+/**
+* @brief Appends text to the transmit queue, waiting only while the queue is full
+*
+* @param1 text bytes to send
+* @param2 size number of bytes
+* @return none
+*/
+void uart0_put(const char *text, uint32_t size);
+
 
 
 #endif
@@ -320,6 +320,9 @@ void ResetISR(void) {
 	SectionTableAddr = &__data_section_table;
 
     // Copy the data sections from flash to SRAM.
+    // The .ramfunc sections (RAMFUNC in ramfunc.h) are placed at the start of
+    // .data, so this also copies the RAM-resident functions. None of them may
+    // be called before this loop, which is why SystemInit() is not one.
 	while (SectionTableAddr < &__data_section_table_end) {
 		LoadAddr = *SectionTableAddr++;
 		ExeAddr = *SectionTableAddr++;
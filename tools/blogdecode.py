@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""Decode the output of the blog dump command back into text.
+
+Usage: blogdecode.py DigitalGuage.axf capture.bin
+
+capture.bin is the raw serial capture of "blog dump": a text line
+"BLOG <entries> <cycles per tick> <overwritten>", the entries as little-endian
+blog_entry_t (id, 1 ms tick count, cycles within the tick, four argument
+words) and "BLOG END". Every entry's id is the address of its format string in
+the .rodata.blog section, with the argument count in the low 3 bits; the format
+string, and any %s argument, are read from the ELF file of the same build.
+"""
+
+import re
+import struct
+import sys
+
+from elf32 import Elf32
+
+ENTRY = struct.Struct("<7I")
+US_PER_TICK = 1000
+ID_ALIGN = 8
+CONVERSION = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z)?([diuxXcsp%])")
+
+
+def format_message(elf, fmt, args):
+    args = list(args)
+
+    def convert(match):
+        flags, kind = match.groups()
+        if kind == "%":
+            return "%"
+        value = args.pop(0) if args else 0
+        if kind == "s":
+            text = elf.string(value)
+            return text if text is not None else "<0x%08x>" % value
+        if kind in "di":
+            value = value - (1 << 32) if value & 0x80000000 else value
+            kind = "d"
+        elif kind == "p":
+            return "0x%08x" % value
+        return ("%" + flags + kind) % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    elf = Elf32(sys.argv[1])
+    with open(sys.argv[2], "rb") as f:
+        capture = f.read()
+    match = re.search(rb"BLOG (\d+) (\d+) (\d+)\n\r", capture)
+    if match is None:
+        sys.exit("no BLOG header in %s" % sys.argv[2])
+    count, cycles_per_tick, overwritten = (int(x) for x in match.groups())
+    body = capture[match.end():match.end() + count * ENTRY.size]
+    if len(body) < count * ENTRY.size:
+        sys.exit("capture is truncated, %d of %d entries" % (len(body) // ENTRY.size, count))
+    if overwritten:
+        print("... %d older messages were overwritten" % overwritten)
+
+    first = None
+    for i in range(count):
+        ident, ticks, cycles, *words = ENTRY.unpack_from(body, i * ENTRY.size)
+        nargs = ident & (ID_ALIGN - 1)
+        fmt = elf.string(ident & ~(ID_ALIGN - 1))
+        if fmt is None:
+            text = "unknown message 0x%08x %s" % (ident, " ".join("0x%08x" % w for w in words[:nargs]))
+        else:
+            text = format_message(elf, fmt, words[:nargs])
+        if first is None:
+            first = (ticks, cycles)
+        elapsed_us = (((ticks - first[0]) & 0xFFFFFFFF) * US_PER_TICK
+                      + (cycles - first[1]) * US_PER_TICK / cycles_per_tick)
+        print("%12.1f us  %s" % (elapsed_us, text))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,62 @@
+"""Just enough of an ELF32 little-endian reader for the host decoding tools.
+
+Reads the allocated sections, to fetch constant data by address, and the function
+symbols, to name code addresses. No dependencies beyond the standard library.
+"""
+
+import bisect
+import struct
+
+SHT_PROGBITS = 1
+SHT_SYMTAB = 2
+STT_FUNC = 2
+
+
+class Elf32:
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1:
+            raise ValueError("%s is not an ELF32 file" % path)
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", self.data, 0x2E)
+        headers = [struct.unpack_from("<10I", self.data, shoff + i * shentsize) for i in range(shnum)]
+
+        self.sections = []
+        self.functions = []
+        for (_, sh_type, _, addr, offset, size, link, _, _, entsize) in headers:
+            if sh_type == SHT_PROGBITS and addr != 0:
+                self.sections.append((addr, offset, size))
+            elif sh_type == SHT_SYMTAB:
+                strtab = headers[link][4]
+                for sym in range(offset, offset + size, entsize):
+                    name, value, sym_size, info, _, _ = struct.unpack_from("<IIIBBH", self.data, sym)
+                    if info & 0xF == STT_FUNC and value != 0:
+                        end = self.data.index(b"\0", strtab + name)
+                        self.functions.append((value & ~1, sym_size, self.data[strtab + name:end].decode()))
+        self.functions.sort()
+        self.function_starts = [f[0] for f in self.functions]
+
+    def string(self, address):
+        """Null terminated string at an address of the image, None if outside it."""
+        for addr, offset, size in self.sections:
+            if addr <= address < addr + size:
+                start = offset + address - addr
+                end = self.data.index(b"\0", start)
+                return self.data[start:end].decode("ascii", "replace")
+        return None
+
+    def function(self, address):
+        """(name, offset) of the function holding a code address, (None, address) if unknown."""
+        i = bisect.bisect_right(self.function_starts, address & ~1) - 1
+        if i >= 0:
+            start, size, name = self.functions[i]
+            if (address & ~1) < start + max(size, 2):
+                return name, (address & ~1) - start
+        return None, address & ~1
+
+    def symbolize(self, address):
+        name, offset = self.function(address)
+        if name is None:
+            return "0x%08x" % offset
+        return "%s+0x%x" % (name, offset) if offset else name
@@ -0,0 +1,164 @@
+/**
+ * @file    fmtbench.c
+ * @brief   Host benchmark of the console formatter in source/fmt.c against the C library
+ * 			snprintf, on the lines the command processor prints
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on the host
+ *
+ * Build and run from this directory:
+ *   cc -O2 -DFMT_HOST -I../source fmtbench.c ../source/fmt.c -o fmtbench && ./fmtbench
+ *
+ * Every case is first checked to give the same text with both formatters. The times
+ * are host times, so only the ratio carries over to the board; on the M0+ the gap is
+ * wider as the library divides in software and carries the float conversion code.
+ */
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "fmt.h"
+
+#define RUNS		1000000
+#define LINE_MAX	128
+
+static char line[LINE_MAX];
+static uint32_t line_length;
+
+/*
+ * @brief Output of fmt.c in a host build, collects the text in line[]
+ */
+void fmt_host_write(const char *text, uint32_t size)
+{
+	if (line_length + size < LINE_MAX)
+	{
+		memcpy(&line[line_length], text, size);
+		line_length += size;
+	}
+	line[line_length] = '\0';
+}
+
+typedef struct
+{
+	const char *name;
+	void (*with_fmt)(int i);
+	void (*with_libc)(int i, char *out);
+} bench_case_t;
+
+static void roll_fmt(int i)
+{
+	fmt_printf("Current Roll Angle: %d\n\r", i % 181);
+}
+
+static void roll_libc(int i, char *out)
+{
+	snprintf(out, LINE_MAX, "Current Roll Angle: %d\n\r", i % 181);
+}
+
+static void measuring_fmt(int i)
+{
+	fmt_printf("Measuring: requested %d, current %d, reference zero %d\n\r", 90, i % 181 - 45, -12);
+}
+
+static void measuring_libc(int i, char *out)
+{
+	snprintf(out, LINE_MAX, "Measuring: requested %d, current %d, reference zero %d\n\r", 90, i % 181 - 45, -12);
+}
+
+static void hex_fmt(int i)
+{
+	fmt_printf("Active sector 0x%05lx, key %lu at 0x%08X\n\r", 0x1F800UL + (unsigned long)i, (unsigned long)(i & 3),
+			(unsigned)i * 2654435761U);
+}
+
+static void hex_libc(int i, char *out)
+{
+	snprintf(out, LINE_MAX, "Active sector 0x%05lx, key %lu at 0x%08X\n\r", 0x1F800UL + (unsigned long)i,
+			(unsigned long)(i & 3), (unsigned)i * 2654435761U);
+}
+
+static void table_fmt(int i)
+{
+	fmt_printf("%-16s\t%6u\t%-4d|%c\n\r", "get_roll", (unsigned)i, -(i % 1000), 'A' + (i % 26));
+}
+
+static void table_libc(int i, char *out)
+{
+	snprintf(out, LINE_MAX, "%-16s\t%6u\t%-4d|%c\n\r", "get_roll", (unsigned)i, -(i % 1000), 'A' + (i % 26));
+}
+
+static void fixed_fmt(int i)
+{
+	fmt_str("gain ");
+	fmt_fixed(10000 + (i % 700) - 350, 4);
+	fmt_str(", angle ");
+	fmt_fixed(-(i % 1801), 1);
+	fmt_str("\n\r");
+}
+
+static void fixed_libc(int i, char *out)
+{
+	double gain = (10000 + (i % 700) - 350) / 10000.0;
+	double angle = -(i % 1801) / 10.0;
+	snprintf(out, LINE_MAX, "gain %.4f, angle %.1f\n\r", gain, angle);
+}
+
+static const bench_case_t cases[] =
+{
+	{"roll angle", roll_fmt, roll_libc},
+	{"measuring", measuring_fmt, measuring_libc},
+	{"hex", hex_fmt, hex_libc},
+	{"padded table", table_fmt, table_libc},
+	{"fixed point", fixed_fmt, fixed_libc},
+};
+
+static double now_ns(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (t.tv_sec * 1e9) + t.tv_nsec;
+}
+
+int main(void)
+{
+	static char expected[LINE_MAX];
+	int failures = 0;
+
+	printf("%-14s %10s %10s %8s\n", "Case", "fmt ns", "libc ns", "Speedup");
+	for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+	{
+		const bench_case_t *bench = &cases[c];
+		for (int i = 0; i < 5000; i += 7)
+		{
+			line_length = 0;
+			bench->with_fmt(i);
+			bench->with_libc(i, expected);
+			if (strcmp(line, expected) != 0)
+			{
+				printf("%s: \"%s\" instead of \"%s\"\n", bench->name, line, expected);
+				failures++;
+				break;
+			}
+		}
+
+		double start = now_ns();
+		for (int i = 0; i < RUNS; i++)
+		{
+			line_length = 0;
+			bench->with_fmt(i);
+		}
+		double fmt_ns = (now_ns() - start) / RUNS;
+
+		start = now_ns();
+		for (int i = 0; i < RUNS; i++)
+		{
+			bench->with_libc(i, expected);
+		}
+		double libc_ns = (now_ns() - start) / RUNS;
+
+		printf("%-14s %10.1f %10.1f %7.2fx\n", bench->name, fmt_ns, libc_ns, libc_ns / fmt_ns);
+	}
+	return (failures == 0) ? 0 : 1;
+}
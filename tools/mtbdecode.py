@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""Decode the output of the trace dump command in to the branches the core took.
+
+Usage: mtbdecode.py DigitalGuage.axf capture.bin
+
+capture.bin is the raw serial capture of "trace dump": a text line
+"MTB <packets> <wrapped>", the Micro Trace Buffer packets oldest first and
+"MTB END". Each packet is two little-endian words: the address branched from,
+with bit 0 set when the branch was an exception entry or return, and the
+address branched to, with bit 0 set on the first packet after tracing started.
+Between two packets the core ran straight through, from the destination of one
+to the source of the next, which is printed as the code executed.
+
+The summary counts the branches taken out of each function and the calls and
+returns between functions, the places to look at in a hot loop.
+"""
+
+import collections
+import re
+import struct
+import sys
+
+from elf32 import Elf32
+
+PACKET = struct.Struct("<II")
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    elf = Elf32(sys.argv[1])
+    with open(sys.argv[2], "rb") as f:
+        capture = f.read()
+    match = re.search(rb"MTB (\d+) (\d+)\n\r", capture)
+    if match is None:
+        sys.exit("no MTB header in %s" % sys.argv[2])
+    count, wrapped = (int(x) for x in match.groups())
+    body = capture[match.end():match.end() + count * PACKET.size]
+    if len(body) < count * PACKET.size:
+        sys.exit("capture is truncated, %d of %d packets" % (len(body) // PACKET.size, count))
+    if wrapped:
+        print("... the buffer wrapped, older branches were lost")
+
+    taken = collections.Counter()        # branches taken out of a function
+    edges = collections.Counter()        # branches between two different functions
+    sites = collections.Counter()        # individual branch instructions
+    previous_destination = None
+    for i in range(count):
+        source, destination = PACKET.unpack_from(body, i * PACKET.size)
+        exception = source & 1
+        start = destination & 1
+        source &= ~1
+        destination &= ~1
+
+        if start:
+            print("-- trace started")
+        elif previous_destination is not None:
+            print("   ran %s .. %s" % (elf.symbolize(previous_destination), elf.symbolize(source)))
+        print("%3d %-32s -> %s%s" % (i, elf.symbolize(source), elf.symbolize(destination),
+                                    "  (exception)" if exception else ""))
+        previous_destination = destination
+
+        from_name = elf.function(source)[0] or "?"
+        to_name = elf.function(destination)[0] or "?"
+        taken[from_name] += 1
+        sites[source] += 1
+        if from_name != to_name:
+            edges[(from_name, to_name)] += 1
+
+    print("\nBranches taken per function")
+    for name, n in taken.most_common():
+        print("%6d  %s" % (n, name))
+    print("\nCalls, returns and exceptions between functions")
+    for (from_name, to_name), n in edges.most_common():
+        print("%6d  %s -> %s" % (n, from_name, to_name))
+    print("\nMost taken branch instructions")
+    for address, n in sites.most_common(10):
+        print("%6d  %s" % (n, elf.symbolize(address)))
+
+
+if __name__ == "__main__":
+    main()
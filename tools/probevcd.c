@@ -0,0 +1,57 @@
+/**
+ * @file    probevcd.c
+ * @brief   Host build of the guidance colour lookup with its probe recorded in to a VCD file,
+ * 			the same edges the PTC4 pin shows on a logic analyzer
+ * @date 	10th December, 2021
+ * @author 	Shreyan Prabhu
+ * @Tools   gcc on the host
+ *
+ * Build and run from this directory, then open probes.vcd in GTKWave or PulseView:
+ *   cc -O2 -DPROBE_HOST -DRAMFUNC_ENABLE=0 -I../source probevcd.c ../source/probe.c \
+ *      ../source/guidance.c -o probevcd && ./probevcd probes.vcd
+ *
+ * The set angle command looks up one colour per 10 ms sample; the sweep below does the
+ * same for every angle of both ramps, with a 10 us gap so the pulses are easy to see.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include "probe.h"
+#include "guidance.h"
+
+#define MAX_ANGLE 180
+#define GAP_NS 10000
+
+static void gap(void)
+{
+	struct timespec start, now;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	do
+	{
+		clock_gettime(CLOCK_MONOTONIC, &now);
+	} while (((now.tv_sec - start.tv_sec) * 1000000000L) + (now.tv_nsec - start.tv_nsec) < GAP_NS);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *path = (argc > 1) ? argv[1] : "probes.vcd";
+	unsigned checksum = 0;
+
+	if (!probe_host_open(path))
+	{
+		perror(path);
+		return 1;
+	}
+	for (int ramp = 0; ramp < GUIDANCE_NUM_RAMPS; ramp++)
+	{
+		for (int angle = 0; angle <= MAX_ANGLE; angle++)
+		{
+			const guidance_colour_t *colour = guidance_colour((guidance_ramp_t)ramp, angle, MAX_ANGLE);
+			checksum += colour->red + colour->green + colour->blue;
+			gap();
+		}
+	}
+	probe_host_close();
+	printf("%d lookups recorded in %s (colour checksum %u)\n", GUIDANCE_NUM_RAMPS * (MAX_ANGLE + 1), path, checksum);
+	return 0;
+}
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+"""Break the static SRAM use of a build down per module, from its linker map.
+
+Usage: ramusage.py DigitalGuage.map [-v]
+
+The map is written next to the .axf by every build. With -ffunction-sections
+and -fdata-sections each variable, and each RAM-resident function, is an input
+section of its own, listed with its address, size and the object file or
+library member it came from; nothing here has to be kept in step with the
+code. Sections outside the SRAM, and the discarded ones, are ignored. The ELF
+symbol table is not enough on its own: global symbols carry no source file.
+
+Every module is shown with its initialised data (variables and RAM functions),
+its zero-initialised bss and its other RAM sections, such as the MTB buffer;
+-v also lists every object of the module. The heap and stack are not sections,
+the mem command reports them.
+"""
+
+import collections
+import os
+import re
+import sys
+
+SRAM_START = 0x1FFFF000
+SRAM_END = 0x20003000
+
+# " .bss.ring  0x1ffff2a0  0x600 ./source/blog.o", long names wrap before the address
+INPUT_SECTION = re.compile(r"^ (\.\S+|COMMON)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$", re.M)
+
+
+def module_name(path):
+    """Module of an input file: the source file name, or the library of an archive member."""
+    path = path.strip()
+    member = re.match(r"(.*\.a)\((.*)\)$", path)
+    if member:
+        return "%s(%s)" % (os.path.basename(member.group(1)), member.group(2))
+    return os.path.splitext(os.path.basename(path))[0]
+
+
+def kind_of(section):
+    if section.startswith(".bss") or section == "COMMON":
+        return "bss"
+    if section.startswith(".data") or section.startswith(".ramfunc"):
+        return "data"
+    return "other"
+
+
+def main():
+    verbose = "-v" in sys.argv[2:]
+    if len(sys.argv) < 2 or sys.argv[1].startswith("-"):
+        sys.exit(__doc__)
+    with open(sys.argv[1]) as f:
+        text = f.read()
+    memory_map = text.find("Linker script and memory map")
+    if memory_map < 0:
+        sys.exit("%s is not a GNU ld map file" % sys.argv[1])
+    text = re.sub(r"^( \S+)\n\s+(0x)", r"\1 \2", text[memory_map:], flags=re.M)
+
+    modules = collections.defaultdict(lambda: collections.Counter())
+    objects = collections.defaultdict(list)
+    for section, address, size, path in INPUT_SECTION.findall(text):
+        address, size = int(address, 16), int(size, 16)
+        if size == 0 or not SRAM_START <= address < SRAM_END:
+            continue
+        module = module_name(path)
+        kind = kind_of(section)
+        modules[module][kind] += size
+        objects[module].append((size, kind, section))
+
+    totals = collections.Counter()
+    print("%-32s%8s%8s%8s%8s" % ("Module", "data", "bss", "other", "total"))
+    for module, sizes in sorted(modules.items(), key=lambda item: -sum(item[1].values())):
+        totals.update(sizes)
+        print("%-32s%8d%8d%8d%8d" % (module, sizes["data"], sizes["bss"], sizes["other"],
+                                     sum(sizes.values())))
+        if verbose:
+            for size, kind, section in sorted(objects[module], reverse=True):
+                print("    %-36s%-6s%6d" % (section, kind, size))
+    print("%-32s%8d%8d%8d%8d" % ("Total", totals["data"], totals["bss"], totals["other"],
+                                 sum(totals.values())))
+
+
+if __name__ == "__main__":
+    main()